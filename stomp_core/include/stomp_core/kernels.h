@@ -0,0 +1,141 @@
+/**
+ * @file kernels.h
+ * @brief This contains the vectorized math kernels used in the stomp core algorithm
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INDUSTRIAL_MOVEIT_STOMP_CORE_INCLUDE_STOMP_CORE_KERNELS_H_
+#define INDUSTRIAL_MOVEIT_STOMP_CORE_INCLUDE_STOMP_CORE_KERNELS_H_
+
+#include <cstddef>
+#include <string>
+
+namespace stomp_core
+{
+
+/**
+ * @brief Kernels that run over contiguous arrays of doubles.
+ *
+ * Each kernel has a portable implementation and, on x86 processors, SSE2, AVX2 and AVX-512 implementations. The
+ * widest instruction set supported by the processor is selected when the library is loaded so that packages built
+ * for a generic target still make use of the full vector width.
+ */
+namespace kernels
+{
+
+namespace InstructionSets
+{
+/** @brief Available kernel implementations */
+enum InstructionSet
+{
+  SCALAR = 0,   /**< Portable implementation */
+  SSE2,         /**< 128 bit vectors */
+  AVX2,         /**< 256 bit vectors with fused multiply-add */
+  AVX512        /**< 512 bit vectors */
+};
+}
+
+/**
+ * @brief Gets the instruction set used by the kernels.
+ * @return The active instruction set
+ */
+InstructionSets::InstructionSet getInstructionSet();
+
+/**
+ * @brief Selects the instruction set used by the kernels. Not thread-safe, intended for testing and benchmarking.
+ * @param instruction_set The requested instruction set
+ * @return True if the processor supports the instruction set, otherwise false and the selection is unchanged.
+ */
+bool setInstructionSet(InstructionSets::InstructionSet instruction_set);
+
+/**
+ * @brief Checks whether the processor supports an instruction set.
+ * @param instruction_set The instruction set
+ * @return True if supported, otherwise false.
+ */
+bool isSupported(InstructionSets::InstructionSet instruction_set);
+
+/**
+ * @brief Gets the name of an instruction set
+ * @param instruction_set The instruction set
+ * @return The name of the instruction set
+ */
+std::string toString(InstructionSets::InstructionSet instruction_set);
+
+/**
+ * @brief Updates the element-wise minimum and maximum with values + offset
+ * @param values      An array [n] of values
+ * @param offset      A constant added to every value
+ * @param n           The number of elements
+ * @param min_values  An array [n] of minimum values, updated in place
+ * @param max_values  An array [n] of maximum values, updated in place
+ */
+void updateMinMax(const double* values, double offset, std::size_t n, double* min_values, double* max_values);
+
+/**
+ * @brief Exponentiates the costs of a rollout and accumulates its probabilities and probability weighted noise, for
+ * every element i:
+ * p = weight * exp((costs[i] + offset - min_costs[i]) * scales[i]),
+ * probability_sums[i] += p,
+ * weighted_noise_sums[i] += p * noise[i]
+ * @param costs               An array [n] of costs
+ * @param offset              A constant added to every cost
+ * @param min_costs           An array [n] of the minimum costs
+ * @param scales              An array [n] of the exponent scales, usually -h/(max_cost - min_cost)
+ * @param weight              The weight of the rollout
+ * @param noise               An array [n] of the rollout noise
+ * @param n                   The number of elements
+ * @param probability_sums    An array [n] of the accumulated probabilities
+ * @param weighted_noise_sums An array [n] of the accumulated probability weighted noise
+ */
+void accumulateProbabilities(const double* costs, double offset, const double* min_costs, const double* scales,
+                             double weight, const double* noise, std::size_t n,
+                             double* probability_sums, double* weighted_noise_sums);
+
+/**
+ * @brief Computes the element-wise division numerators[i]/denominators[i]
+ * @param numerators    An array [n] of numerators
+ * @param denominators  An array [n] of denominators
+ * @param n             The number of elements
+ * @param result        An array [n] of quotients, may alias the numerators
+ */
+void divide(const double* numerators, const double* denominators, std::size_t n, double* result);
+
+/**
+ * @brief Computes the sum of weights[i] * x[i] * y[i], used to apply a banded stencil or cost matrix diagonal by diagonal
+ * @param weights An array [n] of weights
+ * @param x       An array [n]
+ * @param y       An array [n]
+ * @param n       The number of elements
+ * @return The weighted dot product
+ */
+double weightedDot(const double* weights, const double* x, const double* y, std::size_t n);
+
+/**
+ * @brief Computes y[i] += alpha * x[i]
+ * @param alpha The scale factor
+ * @param x     An array [n]
+ * @param n     The number of elements
+ * @param y     An array [n], updated in place
+ */
+void axpy(double alpha, const double* x, std::size_t n, double* y);
+
+} /* namespace kernels */
+
+} /* namespace stomp_core */
+
+#endif /* INDUSTRIAL_MOVEIT_STOMP_CORE_INCLUDE_STOMP_CORE_KERNELS_H_ */
@@ -27,6 +27,9 @@
 #define INDUSTRIAL_MOVEIT_STOMP_CORE_INCLUDE_STOMP_CORE_STOMP_H_
 
 #include <atomic>
+#include <map>
+#include <string>
+#include <tuple>
 #include <stomp_core/utils.h>
 #include <XmlRpc.h>
 #include "stomp_core/task.h"
@@ -34,6 +37,22 @@
 namespace stomp_core
 {
 
+/**
+ * @brief A snapshot of the optimizer state between two iterations from which an interrupted optimization is resumed.
+ * The noise is drawn by the task, the snapshot holds the state of its random generator as given by Task::getNoiseState().
+ */
+struct StompState
+{
+  StompConfiguration config;               /**< @brief The configuration of the optimization */
+  unsigned int iteration;                  /**< @brief The next iteration to run */
+  unsigned int valid_iterations;           /**< @brief The number of consecutive iterations with valid parameters */
+  bool parameters_valid_prev;              /**< @brief Whether the parameters of the lowest cost so far are valid */
+  double lowest_cost;                      /**< @brief The lowest cost of the optimized parameters so far */
+  Eigen::MatrixXd parameters_optimized;    /**< @brief A matrix [dimensions][parameters] of the optimized parameters */
+  std::vector<Rollout> rollouts;           /**< @brief The noisy rollouts along with their costs that the next iteration reuses */
+  std::string noise_state;                 /**< @brief The state of the task's random generator for the next iteration */
+};
+
 /** @brief The Stomp class */
 class Stomp
 {
@@ -74,6 +93,24 @@ public:
   bool solve(const Eigen::MatrixXd& initial_parameters,
              Eigen::MatrixXd& parameters_optimized);
 
+  /**
+   * @brief Continues an optimization from a snapshot, possibly taken from another instance. The task must already be set
+   * up for the same problem, its random generator is restored from the snapshot. A resumed optimization matches an
+   * uninterrupted one when the task implements Task::getNoiseState() or draws its noise deterministically.
+   * @param state The snapshot taken by getState()
+   * @param parameters_optimized The optimized solution [Parameters][timesteps]
+   * @return True if solution was found, otherwise false.
+   */
+  bool resume(const StompState& state,Eigen::MatrixXd& parameters_optimized);
+
+  /**
+   * @brief Takes a snapshot of the optimizer state after a solve, which is most useful when the solve was cancelled. An
+   * iteration interrupted by the cancellation is run again when resuming.
+   * @param state The snapshot
+   * @return True if sucessful, false if no optimization was run since the last reset.
+   */
+  bool getState(StompState& state) const;
+
   /**
    * @brief Sets the configuration and resets all internal variables
    * @param config Stomp Configuration struct
@@ -107,11 +144,38 @@ protected:
    * @brief Computes an inital guess at a solution given a start and end state
    * @param first Start state for the task
    * @param last Final state for the task
+   * @param trajectory The initial trajectory [dimensions][timesteps]
    * @return True if sucessful, otherwise false.
    */
-  bool computeInitialTrajectory(const std::vector<double>& first,const std::vector<double>& last);
+  bool computeInitialTrajectory(const std::vector<double>& first,const std::vector<double>& last,
+                                Eigen::MatrixXd& trajectory);
+
+  /**
+   * @brief Computes the optimization parameters that best fit a trajectory. When B-spline control points are optimized these
+   * are the least squares control points with the first and last ones fixed to the trajectory end points, otherwise the
+   * trajectory is copied.
+   * @param trajectory A matrix [dimensions][timesteps]
+   * @param parameters The fitted parameters [dimensions][parameters]
+   */
+  void fitParameters(const Eigen::MatrixXd& trajectory,Eigen::MatrixXd& parameters) const;
+
+  /**
+   * @brief Evaluates the trajectory corresponding to a set of optimization parameters.
+   * @param parameters A matrix [dimensions][parameters]
+   * @return The trajectory [dimensions][timesteps]. When B-spline control points are optimized this is a reference to an internal
+   * buffer that is overwritten by the next call, otherwise it is the 'parameters' argument.
+   */
+  const Eigen::MatrixXd& evaluateTrajectory(const Eigen::MatrixXd& parameters);
 
   // optimization steps
+  /**
+   * @brief Runs the iterations from the current one until a solution is found, the iterations run out or the optimization
+   * is cancelled, then notifies the task.
+   * @param parameters_optimized The optimized solution [Parameters][timesteps]
+   * @return True if solution was found, otherwise false.
+   */
+  bool optimize(Eigen::MatrixXd& parameters_optimized);
+
   /**
    * @brief Run a single iteration of the stomp algorithm
    * @return True if it was able to succesfully perform a single iteration. False
@@ -153,13 +217,14 @@ protected:
   bool computeRolloutsControlCosts();
 
   /**
-   * @brief Computes the probability from the state cost at every timestep for each noisy rollout.
+   * @brief Computes the probability from the state cost at every timestep for each noisy rollout and
+   * accumulates the parameter updates as the probability weighted convex combination of the noise.
    * @return True if sucessful, otherwise false.
    */
   bool computeProbabilities();
 
   /**
-   * @brief Computes update from probabilities using convex combination
+   * @brief Filters the parameter updates and applies them to the optimized parameters
    * @return True if sucessful, otherwise false.
    */
   bool updateParameters();
@@ -172,6 +237,31 @@ protected:
    */
   bool computeOptimizedCost();
 
+protected:
+
+  /** @brief The finite difference and control cost matrices that only depend on the shape of the problem */
+  struct CostMatrices
+  {
+    Eigen::MatrixXd finite_diff_matrix_A_padded;
+    Eigen::MatrixXd control_cost_matrix_R_padded;
+    Eigen::MatrixXd control_cost_matrix_R;
+    Eigen::MatrixXd inv_control_cost_matrix_R;
+    Eigen::MatrixXd basis_matrix;
+    Eigen::MatrixXd fit_matrix;
+    Eigen::MatrixXd cost_projection_matrix;
+    Eigen::MatrixXd control_point_cost_matrix_R;
+    Eigen::MatrixXd control_cost_bands;
+  };
+
+  /** @brief Key [num_timesteps, num_control_points, delta_t] used to look up previously computed cost matrices */
+  using CostMatricesKey = std::tuple<int,int,double>;
+
+  /**
+   * @brief Computes the finite difference and control cost matrices for the current configuration
+   * @param m The computed matrices
+   */
+  void computeCostMatrices(CostMatrices& m) const;
+
 protected:
 
   // process control
@@ -179,22 +269,29 @@ protected:
   TaskPtr task_;                                   /**< @brief The task to be optimized. */
   StompConfiguration config_;                      /**< @brief Configuration parameters. */
   unsigned int current_iteration_;                 /**< @brief Current iteration for the optimization. */
+  unsigned int valid_iterations_;                  /**< @brief The number of consecutive iterations with valid parameters */
+  bool iteration_complete_;                        /**< @brief Whether the last iteration ran all its steps */
+  std::string noise_state_;                        /**< @brief The state of the task's random generator at the start of the last iteration */
 
   // optimized parameters
   bool parameters_valid_;                          /**< @brief whether or not the optimized parameters are valid */
   bool parameters_valid_prev_;                     /**< @brief whether or not the optimized parameters from the previous iteration are valid */
   double parameters_total_cost_;                   /**< @brief Total cost of the optimized parameters */
   double current_lowest_cost_;                     /**< @brief Hold the lowest cost of the optimized parameters */
-  Eigen::MatrixXd parameters_optimized_;           /**< @brief A matrix [dimensions][timesteps] of the optimized parameters. */
+  Eigen::MatrixXd parameters_optimized_;           /**< @brief A matrix [dimensions][parameters] of the optimized parameters. */
+  int num_parameters_;                             /**< @brief The number of optimized parameters per dimension, either the timesteps or the B-spline control points */
 
-  Eigen::MatrixXd parameters_updates_;             /**< @brief A matrix [dimensions][timesteps] of the parameter updates*/
+  Eigen::MatrixXd parameters_updates_;             /**< @brief A matrix [dimensions][parameters] of the parameter updates*/
   Eigen::VectorXd parameters_state_costs_;         /**< @brief A vector [timesteps] of the parameters state costs */
-  Eigen::MatrixXd parameters_control_costs_;       /**< @brief A matrix [dimensions][timesteps] of the parameters control costs*/
+  Eigen::VectorXd parameters_control_costs_;       /**< @brief A vector [dimensions] of the parameters control costs at every timestep */
 
   // rollouts
   std::vector<Rollout> noisy_rollouts_;            /**< @brief Holds the noisy rollouts */
   std::vector<Rollout> reused_rollouts_;           /**< @brief Used for reordering arrays based on cost */
   int num_active_rollouts_;                        /**< @brief Number of active rollouts */
+  int num_reused_rollouts_;                        /**< @brief Number of rollouts at the front of reused_rollouts_ reused by the current iteration */
+  std::vector<Eigen::MatrixXd> batch_trajectories_; /**< @brief The trajectories [dimensions][timesteps] of the noisy rollouts passed to Task::computeNoisyCostsBatch */
+  std::vector<Eigen::VectorXd> batch_state_costs_;  /**< @brief The state costs [timesteps] of the noisy rollouts returned by Task::computeNoisyCostsBatch */
 
   // finite difference and optimization matrices
   int num_timesteps_padded_;                       /**< @brief The number of timesteps to pad the optimization with: timesteps + 2*(FINITE_DIFF_RULE_LENGTH - 1) */
@@ -204,6 +301,25 @@ protected:
   Eigen::MatrixXd control_cost_matrix_R_;          /**< @brief A matrix [timesteps][timesteps], Referred to as 'R = A x A_transpose' in the literature */
   Eigen::MatrixXd inv_control_cost_matrix_R_;      /**< @brief A matrix [timesteps][timesteps], R^-1 ' matrix */
 
+  // B-spline control point parameterization
+  Eigen::MatrixXd basis_matrix_;                   /**< @brief A matrix [control points][timesteps] that evaluates the trajectory from the control points */
+  Eigen::MatrixXd fit_matrix_;                     /**< @brief A matrix [timesteps][control points], the least squares inverse of the basis matrix */
+  Eigen::MatrixXd cost_projection_matrix_;         /**< @brief A matrix [control points][timesteps] that maps the state costs onto the control points */
+  Eigen::MatrixXd control_point_cost_matrix_R_;    /**< @brief A matrix [control points][control points], the control cost matrix in control point space B*R*B^T */
+  Eigen::MatrixXd control_point_state_costs_;      /**< @brief A matrix [control points][rollouts] of the state costs mapped onto the control points */
+  Eigen::MatrixXd parameters_trajectory_;          /**< @brief A matrix [dimensions][timesteps] used to evaluate the trajectory of a set of control points */
+
+  Eigen::MatrixXd control_cost_bands_;             /**< @brief A matrix [parameters][bandwidth + 1], column k holds the k-th upper diagonal of the control cost matrix */
+
+  // kernel buffers
+  Eigen::VectorXd min_costs_;                      /**< @brief A vector [parameters] of the minimum rollout cost at each parameter */
+  Eigen::VectorXd cost_scales_;                    /**< @brief A vector [parameters] of the maximum rollout cost, then of the exponent scale at each parameter */
+  Eigen::VectorXd probability_sums_;               /**< @brief A vector [parameters] of the sum of the rollout probabilities at each parameter */
+  Eigen::VectorXd weighted_noise_sums_;            /**< @brief A vector [parameters] of the sum of the probability weighted noise at each parameter */
+  Eigen::VectorXd parameters_row_;                 /**< @brief A vector [parameters] holding a contiguous copy of a single dimension */
+
+  std::map<CostMatricesKey,CostMatrices> cost_matrices_cache_; /**< @brief Cost matrices for each problem shape seen so far, reused on later resets */
+
 
 };
 
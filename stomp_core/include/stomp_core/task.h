@@ -29,6 +29,8 @@
 #include <XmlRpcValue.h>
 #include <boost/shared_ptr.hpp>
 #include <Eigen/Core>
+#include <string>
+#include <vector>
 #include "stomp_core/utils.h"
 
 namespace stomp_core
@@ -37,7 +39,13 @@ namespace stomp_core
 class Task;
 typedef std::shared_ptr<Task> TaskPtr; /**< Defines a boost shared ptr for type Task */
 
-/** @brief Defines the STOMP improvement policy */
+/**
+ * @brief Defines the STOMP improvement policy
+ *
+ * When StompConfiguration::num_control_points is set the noise generation and filtering methods operate on the
+ * B-spline control points [num_dimensions][num_control_points] whereas the cost, postIteration and done methods
+ * receive the trajectory evaluated at every timestep [num_dimensions][num_timesteps].
+ */
 class Task
 {
 
@@ -83,6 +91,46 @@ public:
                          Eigen::VectorXd& costs,
                          bool& validity) = 0 ;
 
+    /**
+     * @brief Whether computeNoisyCostsBatch() should be called instead of computeNoisyCosts() for each rollout.
+     * @return True if the task evaluates all the rollouts of an iteration in one call, otherwise false.
+     */
+    virtual bool supportsNoisyCostsBatch() const
+    {
+      return false;
+    }
+
+    /**
+     * @brief computes the state costs of all the noisy rollouts of an iteration in a single call so that the task can
+     * evaluate them concurrently. Only called when supportsNoisyCostsBatch() returns true.
+     * @param parameters        The matrices [num_dimensions][num_parameters] of each rollout, indexed by the rollout number
+     * @param start_timestep    The start index into the 'parameters' arrays, usually 0.
+     * @param num_timesteps     The number of elements to use from 'parameters' starting from 'start_timestep'
+     * @param iteration_number  The current iteration count in the optimization loop
+     * @param costs             The vectors of the state costs per timestep of each rollout, already sized.
+     * @param validity          Whether or not all the trajectories are valid
+     * @return True if all the costs were properly computed, otherwise false
+     */
+    virtual bool computeNoisyCostsBatch(const std::vector<Eigen::MatrixXd>& parameters,
+                                        std::size_t start_timestep,
+                                        std::size_t num_timesteps,
+                                        int iteration_number,
+                                        std::vector<Eigen::VectorXd>& costs,
+                                        bool& validity)
+    {
+      validity = true;
+      for(auto r = 0u; r < parameters.size(); r++)
+      {
+        bool valid;
+        if(!computeNoisyCosts(parameters[r],start_timestep,num_timesteps,iteration_number,r,costs[r],valid))
+        {
+          return false;
+        }
+        validity &= valid;
+      }
+      return true;
+    }
+
     /**
      * @brief computes the state costs as a function of the optimized parameters for each time step.
      * @param parameters        A matrix [num_dimensions][num_parameters] of the policy parameters to execute
@@ -154,6 +202,28 @@ public:
     virtual void postIteration(std::size_t start_timestep,
                                   std::size_t num_timesteps,int iteration_number,double cost,const Eigen::MatrixXd& parameters){}
 
+    /**
+     * @brief Gets the state of the random generator the noise is drawn from, it is part of the optimizer snapshot so that
+     * a resumed optimization draws the same noise as an uninterrupted one.
+     * @param state The generator state, left empty by a task whose noise does not depend on earlier draws
+     * @return True if succeeded, otherwise false.
+     */
+    virtual bool getNoiseState(std::string& state) const
+    {
+      state.clear();
+      return true;
+    }
+
+    /**
+     * @brief Restores the state of the random generator the noise is drawn from when an optimization is resumed.
+     * @param state The generator state returned by getNoiseState()
+     * @return True if succeeded, otherwise false.
+     */
+    virtual bool setNoiseState(const std::string& state)
+    {
+      return true;
+    }
+
 
     /**
      * @brief Called by Stomp at the end of the optimization process
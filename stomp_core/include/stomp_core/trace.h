@@ -0,0 +1,198 @@
+/**
+ * @file trace.h
+ * @brief This contains a tracer that records timed spans of the planning work in the Chrome trace event format
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INDUSTRIAL_MOVEIT_STOMP_CORE_INCLUDE_STOMP_CORE_TRACE_H_
+#define INDUSTRIAL_MOVEIT_STOMP_CORE_INCLUDE_STOMP_CORE_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace stomp_core
+{
+
+/**
+ * @brief Records the spans of every thread of the process while tracing is started and writes them as a Chrome trace
+ * event JSON file, which can be opened in chrome://tracing or Perfetto. Each thread appends to its own buffer so that
+ * the threads do not contend with each other, and nothing is recorded while tracing is stopped.
+ */
+class Tracer
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /** @brief A completed span */
+  struct Event
+  {
+    std::string name;
+    const char* category;         /**< @brief A string literal */
+    const char* arg_name;         /**< @brief A string literal naming the argument, null if none */
+    long arg_value;
+    Clock::time_point begin;
+    Clock::time_point end;
+  };
+
+  /**
+   * @brief Getter for the tracer of the process
+   * @return The tracer
+   */
+  static Tracer& getInstance();
+
+  /**
+   * @brief Checks whether the spans are being recorded
+   * @return True if tracing is started, otherwise false.
+   */
+  static bool isEnabled()
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Discards the recorded spans and starts recording
+   * @param max_events  The number of spans after which the later ones are dropped
+   */
+  void start(std::size_t max_events = 1000000);
+
+  /**
+   * @brief Stops recording, the recorded spans are kept until the next start()
+   */
+  void stop();
+
+  /**
+   * @brief Writes the recorded spans to a Chrome trace event JSON file, the spans of each thread are in its own track.
+   * @param filename  The file
+   * @return True if succeeded, otherwise false.
+   */
+  bool save(const std::string& filename) const;
+
+  /**
+   * @brief Adds a span to the buffer of the calling thread, does nothing unless tracing is started
+   * @param event The span
+   */
+  void record(Event&& event);
+
+  /**
+   * @brief Getter for the number of spans recorded since start()
+   * @return The number of spans
+   */
+  std::size_t getNumEvents() const;
+
+protected:
+
+  /** @brief The spans recorded by a thread */
+  struct ThreadBuffer
+  {
+    std::mutex mutex;               /**< @brief Only contended while the spans are being saved */
+    std::vector<Event> events;
+    int thread_id;                  /**< @brief The track of the thread in the trace, numbered in order of first use */
+  };
+
+  Tracer();
+
+  /**
+   * @brief Getter for the buffer of the calling thread, created on first use
+   * @return The buffer
+   */
+  ThreadBuffer& getThreadBuffer();
+
+protected:
+
+  static std::atomic<bool> enabled_;
+
+  mutable std::mutex mutex_;
+  std::vector< std::shared_ptr<ThreadBuffer> > buffers_;  /**< @brief The buffers of all the threads that recorded spans */
+  int num_threads_;
+  Clock::time_point start_time_;                          /**< @brief The time the trace timestamps are relative to */
+  std::size_t max_events_;
+  std::atomic<std::size_t> num_events_;
+  std::atomic<std::size_t> num_dropped_;
+};
+
+/**
+ * @brief Records the time from its construction to its destruction as a span of the calling thread when tracing was
+ * started at construction.
+ */
+class TraceSpan
+{
+public:
+  /**
+   * @brief Constructor, begins the span
+   * @param name        The span name, shown in the trace
+   * @param category    The span category, a string literal
+   * @param arg_name    The name of an argument shown with the span, a string literal or null if none
+   * @param arg_value   The value of the argument
+   */
+  TraceSpan(const char* name, const char* category, const char* arg_name = nullptr, long arg_value = 0):
+    active_(Tracer::isEnabled())
+  {
+    if(active_)
+    {
+      event_.name = name;
+      event_.category = category;
+      event_.arg_name = arg_name;
+      event_.arg_value = arg_value;
+      event_.begin = Tracer::Clock::now();
+    }
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  /**
+   * @brief Destructor, ends the span
+   */
+  ~TraceSpan()
+  {
+    if(active_)
+    {
+      event_.end = Tracer::Clock::now();
+      Tracer::getInstance().record(std::move(event_));
+    }
+  }
+
+  /**
+   * @brief Checks whether the span is recorded, so that names that are costly to get are only set when needed
+   * @return True if the span is recorded, otherwise false.
+   */
+  bool isActive() const
+  {
+    return active_;
+  }
+
+  /**
+   * @brief Replaces the span name
+   * @param name  The span name
+   */
+  void setName(const std::string& name)
+  {
+    event_.name = name;
+  }
+
+protected:
+  bool active_;
+  Tracer::Event event_;
+};
+
+} /* namespace stomp_core */
+
+#endif /* INDUSTRIAL_MOVEIT_STOMP_CORE_INCLUDE_STOMP_CORE_TRACE_H_ */
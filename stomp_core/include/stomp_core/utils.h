@@ -40,13 +40,12 @@ struct Rollout
   Eigen::MatrixXd parameters_noise;        /**< @brief A matrix [num_dimensions][num_time_steps] of the sum of parameters + noise */
 
   Eigen::VectorXd state_costs;             /**< @brief A vector [num_time_steps] of the cost at each timestep */
-  Eigen::MatrixXd control_costs;           /**< @brief A matrix [num_dimensions][num_time_steps] of the control cost for each parameter at every timestep */
-  Eigen::MatrixXd total_costs;             /**< @brief A matrix [num_dimensions][num_time_steps] of the total cost, where total_cost[d] = state_costs_ + control_costs_[d]*/
-  Eigen::MatrixXd probabilities;           /**< @brief A matrix [num_dimensions][num_time_steps] of the probability for each parameter at every timestep */
+  Eigen::VectorXd control_costs;           /**< @brief A vector [num_dimensions] of the control cost applied to each parameter at every timestep, the total cost
+                                                at (d,t) is state_costs[t] + control_costs[d] */
 
   std::vector<double> full_probabilities; /**< @brief A vector [num_dimensions] of the probabilities for the full trajectory */
   std::vector<double> full_costs;         /**< @brief A vector [num_dimensions] of the full coss, state_cost + control_cost for each joint over the entire trajectory
-                                               full_costs_[d] = state_cost.sum() + control_cost[d].sum() */
+                                               full_costs_[d] = state_cost.sum() + num_time_steps*control_cost[d] */
 
   double importance_weight;               /**< @brief importance sampling weight */
   double total_cost;                      /**< @brief combined state + control cost over the entire trajectory for all joints */
@@ -97,11 +96,19 @@ struct StompConfiguration
 
   // Cost calculation
   double control_cost_weight;            /**< @brief Percentage of the trajectory accelerations cost to be applied in the total cost calculation >*/
+
+  // Parameterization
+  int num_control_points = 0;            /**< @brief Number of cubic B-spline control points optimized per dimension. When 0 every timestep is
+                                              optimized directly, otherwise the noise and updates live in control point space and the trajectory
+                                              [num_dimensions][num_timesteps] is evaluated from the control points. */
 };
 
 /** @brief The number of columns in the finite differentiation rule */
 static const int FINITE_DIFF_RULE_LENGTH = 7;
 
+/** @brief The degree of the B-spline used when optimizing control points */
+static const int BSPLINE_DEGREE = 3;
+
 /** @brief Contains the coefficients for each of the finite central differentiation (position, velocity, acceleration, and jerk) */
 static const double FINITE_CENTRAL_DIFF_COEFFS[FINITE_DIFF_RULE_LENGTH][FINITE_DIFF_RULE_LENGTH] = {
     {0, 0        , 0        , 1        , 0        , 0         , 0      }, // position
@@ -146,6 +153,24 @@ void differentiate(const Eigen::VectorXd& parameters, DerivativeOrders::Derivati
  */
 void generateSmoothingMatrix(int num_time_steps, double dt, Eigen::MatrixXd& projection_matrix_M);
 
+/**
+ * @brief Generate the basis matrix B of a clamped uniform B-spline of degree BSPLINE_DEGREE, such that the
+ * trajectory [dimensions][timesteps] evaluated from the control points [dimensions][control points] is control_points * B.
+ * The curve starts at the first control point and ends at the last one.
+ * @param num_control_points  The number of control points, must be greater than BSPLINE_DEGREE
+ * @param num_time_steps      The number of timesteps at which the curve is evaluated
+ * @param basis_matrix        The basis matrix [control points][timesteps]
+ */
+void generateBSplineBasisMatrix(int num_control_points, int num_time_steps, Eigen::MatrixXd& basis_matrix);
+
+/**
+ * @brief Gets the number of parameters optimized per dimension.
+ * @param config  The Stomp configuration
+ * @return The number of B-spline control points when the configuration enables a valid control point
+ * parameterization, otherwise the number of timesteps.
+ */
+int getNumParameters(const StompConfiguration& config);
+
 /**
  * @brief Convert a Eigen::MatrixXd to a std::vector<Eigen::VectorXd>
  * Each element in the std::vector represents a row in the Eigen::MatrixXd
@@ -0,0 +1,569 @@
+/**
+ * @file kernels.cpp
+ * @brief This contains the vectorized math kernels used in the stomp core algorithm
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stomp_core/kernels.h>
+#include <cmath>
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define STOMP_CORE_X86_KERNELS
+#include <immintrin.h>
+#define STOMP_TARGET_SSE2 __attribute__((target("sse2")))
+#define STOMP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define STOMP_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace
+{
+
+/** @brief The table of kernel implementations for one instruction set */
+struct KernelTable
+{
+  void (*update_min_max)(const double*, double, std::size_t, double*, double*);
+  void (*accumulate_probabilities)(const double*, double, const double*, const double*, double, const double*, std::size_t,
+                                   double*, double*);
+  void (*divide)(const double*, const double*, std::size_t, double*);
+  double (*weighted_dot)(const double*, const double*, const double*, std::size_t);
+  void (*axpy)(double, const double*, std::size_t, double*);
+};
+
+// exponent range that keeps the result a normal double
+static const double EXP_MAX_ARG = 708.0;
+static const double EXP_MIN_ARG = -708.0;
+
+// Cephes exp coefficients, exp(x) = 2^n * exp(r) where r = x - n*ln(2) and exp(r) = 1 + 2*r*P(r^2)/(Q(r^2) - r*P(r^2))
+static const double EXP_LOG2E = 1.4426950408889634073599;
+static const double EXP_C1 = 6.93145751953125e-1;
+static const double EXP_C2 = 1.42860682030941723212e-6;
+static const double EXP_P0 = 1.26177193074810590878e-4;
+static const double EXP_P1 = 3.02994407707441961300e-2;
+static const double EXP_P2 = 9.99999999999999999910e-1;
+static const double EXP_Q0 = 3.00198505138664455042e-6;
+static const double EXP_Q1 = 2.52448340349684104192e-3;
+static const double EXP_Q2 = 2.27265548208155028766e-1;
+static const double EXP_Q3 = 2.00000000000000000009e0;
+
+/****************************************************************
+ * Portable implementation
+ ****************************************************************/
+namespace scalar
+{
+
+void updateMinMax(const double* values, double offset, std::size_t n, double* min_values, double* max_values)
+{
+  for(std::size_t i = 0; i < n; i++)
+  {
+    double v = values[i] + offset;
+    min_values[i] = std::min(min_values[i],v);
+    max_values[i] = std::max(max_values[i],v);
+  }
+}
+
+void accumulateProbabilities(const double* costs, double offset, const double* min_costs, const double* scales,
+                             double weight, const double* noise, std::size_t n,
+                             double* probability_sums, double* weighted_noise_sums)
+{
+  for(std::size_t i = 0; i < n; i++)
+  {
+    double p = weight * std::exp((costs[i] + offset - min_costs[i]) * scales[i]);
+    probability_sums[i] += p;
+    weighted_noise_sums[i] += p * noise[i];
+  }
+}
+
+void divide(const double* numerators, const double* denominators, std::size_t n, double* result)
+{
+  for(std::size_t i = 0; i < n; i++)
+  {
+    result[i] = numerators[i] / denominators[i];
+  }
+}
+
+double weightedDot(const double* weights, const double* x, const double* y, std::size_t n)
+{
+  double sum = 0.0;
+  for(std::size_t i = 0; i < n; i++)
+  {
+    sum += weights[i] * x[i] * y[i];
+  }
+  return sum;
+}
+
+void axpy(double alpha, const double* x, std::size_t n, double* y)
+{
+  for(std::size_t i = 0; i < n; i++)
+  {
+    y[i] += alpha * x[i];
+  }
+}
+
+static const KernelTable TABLE = {updateMinMax, accumulateProbabilities, divide, weightedDot, axpy};
+
+} /* namespace scalar */
+
+#ifdef STOMP_CORE_X86_KERNELS
+
+/****************************************************************
+ * SSE2 implementation
+ ****************************************************************/
+namespace sse2
+{
+
+static const std::size_t WIDTH = 2;
+
+STOMP_TARGET_SSE2 static inline __m128d exp(__m128d x)
+{
+  x = _mm_min_pd(_mm_max_pd(x,_mm_set1_pd(EXP_MIN_ARG)),_mm_set1_pd(EXP_MAX_ARG));
+
+  // n = round(x/ln(2)), r = x - n*ln(2)
+  __m128i ni = _mm_cvtpd_epi32(_mm_mul_pd(x,_mm_set1_pd(EXP_LOG2E)));
+  __m128d n = _mm_cvtepi32_pd(ni);
+  x = _mm_sub_pd(x,_mm_mul_pd(n,_mm_set1_pd(EXP_C1)));
+  x = _mm_sub_pd(x,_mm_mul_pd(n,_mm_set1_pd(EXP_C2)));
+
+  __m128d xx = _mm_mul_pd(x,x);
+  __m128d px = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(EXP_P0),xx),_mm_set1_pd(EXP_P1));
+  px = _mm_add_pd(_mm_mul_pd(px,xx),_mm_set1_pd(EXP_P2));
+  px = _mm_mul_pd(px,x);
+  __m128d qx = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(EXP_Q0),xx),_mm_set1_pd(EXP_Q1));
+  qx = _mm_add_pd(_mm_mul_pd(qx,xx),_mm_set1_pd(EXP_Q2));
+  qx = _mm_add_pd(_mm_mul_pd(qx,xx),_mm_set1_pd(EXP_Q3));
+  x = _mm_div_pd(px,_mm_sub_pd(qx,px));
+  x = _mm_add_pd(_mm_set1_pd(1.0),_mm_add_pd(x,x));
+
+  // 2^n assembled in the exponent bits
+  ni = _mm_add_epi32(ni,_mm_set1_epi32(1023));
+  ni = _mm_shuffle_epi32(ni,_MM_SHUFFLE(3,1,3,0));
+  __m128d pow2n = _mm_castsi128_pd(_mm_slli_epi64(ni,52));
+  return _mm_mul_pd(x,pow2n);
+}
+
+STOMP_TARGET_SSE2 static inline double sum(__m128d v)
+{
+  return _mm_cvtsd_f64(_mm_add_sd(v,_mm_unpackhi_pd(v,v)));
+}
+
+STOMP_TARGET_SSE2 void updateMinMax(const double* values, double offset, std::size_t n, double* min_values, double* max_values)
+{
+  const __m128d o = _mm_set1_pd(offset);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    __m128d v = _mm_add_pd(_mm_loadu_pd(values + i),o);
+    _mm_storeu_pd(min_values + i,_mm_min_pd(_mm_loadu_pd(min_values + i),v));
+    _mm_storeu_pd(max_values + i,_mm_max_pd(_mm_loadu_pd(max_values + i),v));
+  }
+  scalar::updateMinMax(values + i,offset,n - i,min_values + i,max_values + i);
+}
+
+STOMP_TARGET_SSE2 void accumulateProbabilities(const double* costs, double offset, const double* min_costs, const double* scales,
+                                               double weight, const double* noise, std::size_t n,
+                                               double* probability_sums, double* weighted_noise_sums)
+{
+  const __m128d o = _mm_set1_pd(offset);
+  const __m128d w = _mm_set1_pd(weight);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    __m128d c = _mm_sub_pd(_mm_add_pd(_mm_loadu_pd(costs + i),o),_mm_loadu_pd(min_costs + i));
+    __m128d p = _mm_mul_pd(w,exp(_mm_mul_pd(c,_mm_loadu_pd(scales + i))));
+    _mm_storeu_pd(probability_sums + i,_mm_add_pd(_mm_loadu_pd(probability_sums + i),p));
+    _mm_storeu_pd(weighted_noise_sums + i,_mm_add_pd(_mm_loadu_pd(weighted_noise_sums + i),
+                                                     _mm_mul_pd(p,_mm_loadu_pd(noise + i))));
+  }
+  scalar::accumulateProbabilities(costs + i,offset,min_costs + i,scales + i,weight,noise + i,n - i,
+                                  probability_sums + i,weighted_noise_sums + i);
+}
+
+STOMP_TARGET_SSE2 void divide(const double* numerators, const double* denominators, std::size_t n, double* result)
+{
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    _mm_storeu_pd(result + i,_mm_div_pd(_mm_loadu_pd(numerators + i),_mm_loadu_pd(denominators + i)));
+  }
+  scalar::divide(numerators + i,denominators + i,n - i,result + i);
+}
+
+STOMP_TARGET_SSE2 double weightedDot(const double* weights, const double* x, const double* y, std::size_t n)
+{
+  __m128d acc = _mm_setzero_pd();
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    acc = _mm_add_pd(acc,_mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(weights + i),_mm_loadu_pd(x + i)),_mm_loadu_pd(y + i)));
+  }
+  return sum(acc) + scalar::weightedDot(weights + i,x + i,y + i,n - i);
+}
+
+STOMP_TARGET_SSE2 void axpy(double alpha, const double* x, std::size_t n, double* y)
+{
+  const __m128d a = _mm_set1_pd(alpha);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    _mm_storeu_pd(y + i,_mm_add_pd(_mm_loadu_pd(y + i),_mm_mul_pd(a,_mm_loadu_pd(x + i))));
+  }
+  scalar::axpy(alpha,x + i,n - i,y + i);
+}
+
+static const KernelTable TABLE = {updateMinMax, accumulateProbabilities, divide, weightedDot, axpy};
+
+} /* namespace sse2 */
+
+/****************************************************************
+ * AVX2 implementation
+ ****************************************************************/
+namespace avx2
+{
+
+static const std::size_t WIDTH = 4;
+
+STOMP_TARGET_AVX2 static inline __m256d exp(__m256d x)
+{
+  x = _mm256_min_pd(_mm256_max_pd(x,_mm256_set1_pd(EXP_MIN_ARG)),_mm256_set1_pd(EXP_MAX_ARG));
+
+  // n = round(x/ln(2)), r = x - n*ln(2)
+  __m128i ni = _mm256_cvtpd_epi32(_mm256_mul_pd(x,_mm256_set1_pd(EXP_LOG2E)));
+  __m256d n = _mm256_cvtepi32_pd(ni);
+  x = _mm256_fnmadd_pd(n,_mm256_set1_pd(EXP_C1),x);
+  x = _mm256_fnmadd_pd(n,_mm256_set1_pd(EXP_C2),x);
+
+  __m256d xx = _mm256_mul_pd(x,x);
+  __m256d px = _mm256_fmadd_pd(_mm256_set1_pd(EXP_P0),xx,_mm256_set1_pd(EXP_P1));
+  px = _mm256_fmadd_pd(px,xx,_mm256_set1_pd(EXP_P2));
+  px = _mm256_mul_pd(px,x);
+  __m256d qx = _mm256_fmadd_pd(_mm256_set1_pd(EXP_Q0),xx,_mm256_set1_pd(EXP_Q1));
+  qx = _mm256_fmadd_pd(qx,xx,_mm256_set1_pd(EXP_Q2));
+  qx = _mm256_fmadd_pd(qx,xx,_mm256_set1_pd(EXP_Q3));
+  x = _mm256_div_pd(px,_mm256_sub_pd(qx,px));
+  x = _mm256_add_pd(_mm256_set1_pd(1.0),_mm256_add_pd(x,x));
+
+  // 2^n assembled in the exponent bits
+  __m256i ni64 = _mm256_add_epi64(_mm256_cvtepi32_epi64(ni),_mm256_set1_epi64x(1023));
+  __m256d pow2n = _mm256_castsi256_pd(_mm256_slli_epi64(ni64,52));
+  return _mm256_mul_pd(x,pow2n);
+}
+
+STOMP_TARGET_AVX2 static inline double sum(__m256d v)
+{
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v),_mm256_extractf128_pd(v,1));
+  return _mm_cvtsd_f64(_mm_add_sd(s,_mm_unpackhi_pd(s,s)));
+}
+
+STOMP_TARGET_AVX2 void updateMinMax(const double* values, double offset, std::size_t n, double* min_values, double* max_values)
+{
+  const __m256d o = _mm256_set1_pd(offset);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    __m256d v = _mm256_add_pd(_mm256_loadu_pd(values + i),o);
+    _mm256_storeu_pd(min_values + i,_mm256_min_pd(_mm256_loadu_pd(min_values + i),v));
+    _mm256_storeu_pd(max_values + i,_mm256_max_pd(_mm256_loadu_pd(max_values + i),v));
+  }
+  scalar::updateMinMax(values + i,offset,n - i,min_values + i,max_values + i);
+}
+
+STOMP_TARGET_AVX2 void accumulateProbabilities(const double* costs, double offset, const double* min_costs, const double* scales,
+                                               double weight, const double* noise, std::size_t n,
+                                               double* probability_sums, double* weighted_noise_sums)
+{
+  const __m256d o = _mm256_set1_pd(offset);
+  const __m256d w = _mm256_set1_pd(weight);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    __m256d c = _mm256_sub_pd(_mm256_add_pd(_mm256_loadu_pd(costs + i),o),_mm256_loadu_pd(min_costs + i));
+    __m256d p = _mm256_mul_pd(w,exp(_mm256_mul_pd(c,_mm256_loadu_pd(scales + i))));
+    _mm256_storeu_pd(probability_sums + i,_mm256_add_pd(_mm256_loadu_pd(probability_sums + i),p));
+    _mm256_storeu_pd(weighted_noise_sums + i,_mm256_fmadd_pd(p,_mm256_loadu_pd(noise + i),
+                                                             _mm256_loadu_pd(weighted_noise_sums + i)));
+  }
+  scalar::accumulateProbabilities(costs + i,offset,min_costs + i,scales + i,weight,noise + i,n - i,
+                                  probability_sums + i,weighted_noise_sums + i);
+}
+
+STOMP_TARGET_AVX2 void divide(const double* numerators, const double* denominators, std::size_t n, double* result)
+{
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    _mm256_storeu_pd(result + i,_mm256_div_pd(_mm256_loadu_pd(numerators + i),_mm256_loadu_pd(denominators + i)));
+  }
+  scalar::divide(numerators + i,denominators + i,n - i,result + i);
+}
+
+STOMP_TARGET_AVX2 double weightedDot(const double* weights, const double* x, const double* y, std::size_t n)
+{
+  __m256d acc = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    acc = _mm256_fmadd_pd(_mm256_mul_pd(_mm256_loadu_pd(weights + i),_mm256_loadu_pd(x + i)),_mm256_loadu_pd(y + i),acc);
+  }
+  return sum(acc) + scalar::weightedDot(weights + i,x + i,y + i,n - i);
+}
+
+STOMP_TARGET_AVX2 void axpy(double alpha, const double* x, std::size_t n, double* y)
+{
+  const __m256d a = _mm256_set1_pd(alpha);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    _mm256_storeu_pd(y + i,_mm256_fmadd_pd(a,_mm256_loadu_pd(x + i),_mm256_loadu_pd(y + i)));
+  }
+  scalar::axpy(alpha,x + i,n - i,y + i);
+}
+
+static const KernelTable TABLE = {updateMinMax, accumulateProbabilities, divide, weightedDot, axpy};
+
+} /* namespace avx2 */
+
+/****************************************************************
+ * AVX-512 implementation
+ ****************************************************************/
+namespace avx512
+{
+
+static const std::size_t WIDTH = 8;
+
+STOMP_TARGET_AVX512 static inline __m512d exp(__m512d x)
+{
+  x = _mm512_min_pd(_mm512_max_pd(x,_mm512_set1_pd(EXP_MIN_ARG)),_mm512_set1_pd(EXP_MAX_ARG));
+
+  // n = round(x/ln(2)), r = x - n*ln(2)
+  __m256i ni = _mm512_cvtpd_epi32(_mm512_mul_pd(x,_mm512_set1_pd(EXP_LOG2E)));
+  __m512d n = _mm512_cvtepi32_pd(ni);
+  x = _mm512_fnmadd_pd(n,_mm512_set1_pd(EXP_C1),x);
+  x = _mm512_fnmadd_pd(n,_mm512_set1_pd(EXP_C2),x);
+
+  __m512d xx = _mm512_mul_pd(x,x);
+  __m512d px = _mm512_fmadd_pd(_mm512_set1_pd(EXP_P0),xx,_mm512_set1_pd(EXP_P1));
+  px = _mm512_fmadd_pd(px,xx,_mm512_set1_pd(EXP_P2));
+  px = _mm512_mul_pd(px,x);
+  __m512d qx = _mm512_fmadd_pd(_mm512_set1_pd(EXP_Q0),xx,_mm512_set1_pd(EXP_Q1));
+  qx = _mm512_fmadd_pd(qx,xx,_mm512_set1_pd(EXP_Q2));
+  qx = _mm512_fmadd_pd(qx,xx,_mm512_set1_pd(EXP_Q3));
+  x = _mm512_div_pd(px,_mm512_sub_pd(qx,px));
+  x = _mm512_add_pd(_mm512_set1_pd(1.0),_mm512_add_pd(x,x));
+
+  // 2^n assembled in the exponent bits
+  __m512i ni64 = _mm512_add_epi64(_mm512_cvtepi32_epi64(ni),_mm512_set1_epi64(1023));
+  __m512d pow2n = _mm512_castsi512_pd(_mm512_slli_epi64(ni64,52));
+  return _mm512_mul_pd(x,pow2n);
+}
+
+STOMP_TARGET_AVX512 void updateMinMax(const double* values, double offset, std::size_t n, double* min_values, double* max_values)
+{
+  const __m512d o = _mm512_set1_pd(offset);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    __m512d v = _mm512_add_pd(_mm512_loadu_pd(values + i),o);
+    _mm512_storeu_pd(min_values + i,_mm512_min_pd(_mm512_loadu_pd(min_values + i),v));
+    _mm512_storeu_pd(max_values + i,_mm512_max_pd(_mm512_loadu_pd(max_values + i),v));
+  }
+  scalar::updateMinMax(values + i,offset,n - i,min_values + i,max_values + i);
+}
+
+STOMP_TARGET_AVX512 void accumulateProbabilities(const double* costs, double offset, const double* min_costs, const double* scales,
+                                                 double weight, const double* noise, std::size_t n,
+                                                 double* probability_sums, double* weighted_noise_sums)
+{
+  const __m512d o = _mm512_set1_pd(offset);
+  const __m512d w = _mm512_set1_pd(weight);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    __m512d c = _mm512_sub_pd(_mm512_add_pd(_mm512_loadu_pd(costs + i),o),_mm512_loadu_pd(min_costs + i));
+    __m512d p = _mm512_mul_pd(w,exp(_mm512_mul_pd(c,_mm512_loadu_pd(scales + i))));
+    _mm512_storeu_pd(probability_sums + i,_mm512_add_pd(_mm512_loadu_pd(probability_sums + i),p));
+    _mm512_storeu_pd(weighted_noise_sums + i,_mm512_fmadd_pd(p,_mm512_loadu_pd(noise + i),
+                                                             _mm512_loadu_pd(weighted_noise_sums + i)));
+  }
+  scalar::accumulateProbabilities(costs + i,offset,min_costs + i,scales + i,weight,noise + i,n - i,
+                                  probability_sums + i,weighted_noise_sums + i);
+}
+
+STOMP_TARGET_AVX512 void divide(const double* numerators, const double* denominators, std::size_t n, double* result)
+{
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    _mm512_storeu_pd(result + i,_mm512_div_pd(_mm512_loadu_pd(numerators + i),_mm512_loadu_pd(denominators + i)));
+  }
+  scalar::divide(numerators + i,denominators + i,n - i,result + i);
+}
+
+STOMP_TARGET_AVX512 double weightedDot(const double* weights, const double* x, const double* y, std::size_t n)
+{
+  __m512d acc = _mm512_setzero_pd();
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    acc = _mm512_fmadd_pd(_mm512_mul_pd(_mm512_loadu_pd(weights + i),_mm512_loadu_pd(x + i)),_mm512_loadu_pd(y + i),acc);
+  }
+  return _mm512_reduce_add_pd(acc) + scalar::weightedDot(weights + i,x + i,y + i,n - i);
+}
+
+STOMP_TARGET_AVX512 void axpy(double alpha, const double* x, std::size_t n, double* y)
+{
+  const __m512d a = _mm512_set1_pd(alpha);
+  std::size_t i = 0;
+  for(; i + WIDTH <= n; i += WIDTH)
+  {
+    _mm512_storeu_pd(y + i,_mm512_fmadd_pd(a,_mm512_loadu_pd(x + i),_mm512_loadu_pd(y + i)));
+  }
+  scalar::axpy(alpha,x + i,n - i,y + i);
+}
+
+static const KernelTable TABLE = {updateMinMax, accumulateProbabilities, divide, weightedDot, axpy};
+
+} /* namespace avx512 */
+
+#endif /* STOMP_CORE_X86_KERNELS */
+
+const KernelTable* getTable(stomp_core::kernels::InstructionSets::InstructionSet instruction_set)
+{
+  using namespace stomp_core::kernels::InstructionSets;
+  switch(instruction_set)
+  {
+#ifdef STOMP_CORE_X86_KERNELS
+    case SSE2:
+      return &sse2::TABLE;
+    case AVX2:
+      return &avx2::TABLE;
+    case AVX512:
+      return &avx512::TABLE;
+#endif
+    default:
+      return &scalar::TABLE;
+  }
+}
+
+stomp_core::kernels::InstructionSets::InstructionSet detectInstructionSet()
+{
+  using namespace stomp_core::kernels::InstructionSets;
+#ifdef STOMP_CORE_X86_KERNELS
+  __builtin_cpu_init(); // runs before the constructors that would otherwise initialize the cpu features
+#endif
+  for(auto s : {AVX512, AVX2, SSE2})
+  {
+    if(stomp_core::kernels::isSupported(s))
+    {
+      return s;
+    }
+  }
+  return SCALAR;
+}
+
+// selected when the library is loaded
+stomp_core::kernels::InstructionSets::InstructionSet active_instruction_set = detectInstructionSet();
+const KernelTable* active_table = getTable(active_instruction_set);
+
+} /* namespace */
+
+namespace stomp_core
+{
+
+namespace kernels
+{
+
+bool isSupported(InstructionSets::InstructionSet instruction_set)
+{
+  switch(instruction_set)
+  {
+    case InstructionSets::SCALAR:
+      return true;
+#ifdef STOMP_CORE_X86_KERNELS
+    case InstructionSets::SSE2:
+      return __builtin_cpu_supports("sse2");
+    case InstructionSets::AVX2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case InstructionSets::AVX512:
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+InstructionSets::InstructionSet getInstructionSet()
+{
+  return active_instruction_set;
+}
+
+bool setInstructionSet(InstructionSets::InstructionSet instruction_set)
+{
+  if(!isSupported(instruction_set))
+  {
+    return false;
+  }
+
+  active_instruction_set = instruction_set;
+  active_table = getTable(instruction_set);
+  return true;
+}
+
+std::string toString(InstructionSets::InstructionSet instruction_set)
+{
+  switch(instruction_set)
+  {
+    case InstructionSets::SSE2:
+      return "SSE2";
+    case InstructionSets::AVX2:
+      return "AVX2";
+    case InstructionSets::AVX512:
+      return "AVX512";
+    default:
+      return "SCALAR";
+  }
+}
+
+void updateMinMax(const double* values, double offset, std::size_t n, double* min_values, double* max_values)
+{
+  active_table->update_min_max(values,offset,n,min_values,max_values);
+}
+
+void accumulateProbabilities(const double* costs, double offset, const double* min_costs, const double* scales,
+                             double weight, const double* noise, std::size_t n,
+                             double* probability_sums, double* weighted_noise_sums)
+{
+  active_table->accumulate_probabilities(costs,offset,min_costs,scales,weight,noise,n,probability_sums,weighted_noise_sums);
+}
+
+void divide(const double* numerators, const double* denominators, std::size_t n, double* result)
+{
+  active_table->divide(numerators,denominators,n,result);
+}
+
+double weightedDot(const double* weights, const double* x, const double* y, std::size_t n)
+{
+  return active_table->weighted_dot(weights,x,y,n);
+}
+
+void axpy(double alpha, const double* x, std::size_t n, double* y)
+{
+  active_table->axpy(alpha,x,n,y);
+}
+
+} /* namespace kernels */
+
+} /* namespace stomp_core */
@@ -30,6 +30,9 @@
 #include <Eigen/Cholesky>
 #include <math.h>
 #include <stomp_core/utils.h>
+#include <stomp_core/kernels.h>
+#include <stomp_core/trace.h>
+#include <algorithm>
 #include <numeric>
 #include "stomp_core/stomp.h"
 
@@ -143,21 +146,32 @@ bool computeMinCostTrajectory(const std::vector<double>& first,
  * @param parameters            The parameters used to compute the control cost
  * @param dt                    The timestep in seconds
  * @param control_cost_weight   The control cost weight
- * @param control_cost_matrix_R The control cost matrix
- * @param control_costs returns The parameters control costs
+ * @param control_cost_bands    The upper diagonals of the symmetric control cost matrix [parameters][bandwidth + 1]
+ * @param parameters_row        Buffer used to hold each dimension of the parameters
+ * @param control_costs returns The parameters control costs [dimensions], the same value applies to every timestep
  */
 void computeParametersControlCosts(const Eigen::MatrixXd& parameters,
                                           double dt,
                                           double control_cost_weight,
-                                          const Eigen::MatrixXd& control_cost_matrix_R,
-                                          Eigen::MatrixXd& control_costs)
+                                          const Eigen::MatrixXd& control_cost_bands,
+                                          Eigen::VectorXd& parameters_row,
+                                          Eigen::VectorXd& control_costs)
 {
-  std::size_t num_timesteps = parameters.cols();
+  using namespace stomp_core;
+
+  // x^T*R*x accumulated one diagonal of R at a time
   double cost = 0;
+  const std::size_t n = parameters.cols();
   for(auto d = 0u; d < parameters.rows(); d++)
   {
-    cost = double(parameters.row(d)*(control_cost_matrix_R*parameters.row(d).transpose()));
-    control_costs.row(d).setConstant( 0.5*(1/dt)*cost );
+    parameters_row = parameters.row(d).transpose();
+    const double* x = parameters_row.data();
+    cost = kernels::weightedDot(control_cost_bands.col(0).data(),x,x,n);
+    for(auto k = 1u; k < control_cost_bands.cols(); k++)
+    {
+      cost += 2.0*kernels::weightedDot(control_cost_bands.col(k).data(),x,x + k,n - k);
+    }
+    control_costs(d) = 0.5*(1/dt)*cost;
   }
 
   double max_coeff = control_costs.maxCoeff();
@@ -193,12 +207,14 @@ bool Stomp::solve(const std::vector<double>& first,const std::vector<double>& la
                   Eigen::MatrixXd& parameters_optimized)
 {
   // initialize trajectory
-  if(!computeInitialTrajectory(first,last))
+  Eigen::MatrixXd initial_trajectory;
+  if(!computeInitialTrajectory(first,last,initial_trajectory))
   {
     ROS_ERROR("Unable to generate initial trajectory");
   }
 
-  return solve(parameters_optimized_,parameters_optimized);
+  fitParameters(initial_trajectory,parameters_optimized_);
+  return solve(initial_trajectory,parameters_optimized);
 }
 
 bool Stomp::solve(const Eigen::VectorXd& first,const Eigen::VectorXd& last,
@@ -217,11 +233,6 @@ bool Stomp::solve(const Eigen::VectorXd& first,const Eigen::VectorXd& last,
 bool Stomp::solve(const Eigen::MatrixXd& initial_parameters,
                   Eigen::MatrixXd& parameters_optimized)
 {
-  if(parameters_optimized_.isZero())
-  {
-    parameters_optimized_ = initial_parameters;
-  }
-
   // check initial trajectory size
   if(initial_parameters.rows() != config_.num_dimensions || initial_parameters.cols() != config_.num_timesteps)
   {
@@ -237,8 +248,13 @@ bool Stomp::solve(const Eigen::MatrixXd& initial_parameters,
     }
   }
 
+  if(parameters_optimized_.isZero())
+  {
+    fitParameters(initial_parameters,parameters_optimized_);
+  }
+
   current_iteration_ = 1;
-  unsigned int valid_iterations = 0;
+  valid_iterations_ = 0;
   current_lowest_cost_ = std::numeric_limits<double>::max();
 
   // computing initialial trajectory cost
@@ -249,6 +265,87 @@ bool Stomp::solve(const Eigen::MatrixXd& initial_parameters,
   }
 
   parameters_valid_prev_ = parameters_valid_;
+  return optimize(parameters_optimized);
+}
+
+bool Stomp::resume(const StompState& state,Eigen::MatrixXd& parameters_optimized)
+{
+  setConfig(state.config);
+  if(state.parameters_optimized.rows() != config_.num_dimensions || state.parameters_optimized.cols() != num_parameters_)
+  {
+    ROS_ERROR("Optimizer state dimensions are incorrect");
+    return false;
+  }
+
+  // the stored rollouts go first, followed by the slot of the optimized parameters
+  std::size_t num_rollouts = std::min<std::size_t>(state.rollouts.size(),config_.max_rollouts - 1);
+  for(auto r = 0u; r < num_rollouts; r++)
+  {
+    noisy_rollouts_[r] = state.rollouts[r];
+  }
+  num_active_rollouts_ = num_rollouts > 0 ? num_rollouts + 1 : 0;
+
+  parameters_optimized_ = state.parameters_optimized;
+  current_iteration_ = state.iteration;
+  valid_iterations_ = state.valid_iterations;
+  current_lowest_cost_ = state.lowest_cost;
+  parameters_valid_prev_ = state.parameters_valid_prev;
+
+  // recomputing the costs of the optimized parameters, these match the ones computed before the snapshot
+  if(!computeOptimizedCost())
+  {
+    ROS_ERROR("Failed to calculate the resumed trajectory cost");
+    return false;
+  }
+
+  parameters_valid_prev_ = state.parameters_valid_prev;
+  if(!task_->setNoiseState(state.noise_state))
+  {
+    ROS_ERROR("Failed to restore the task noise generator state");
+    return false;
+  }
+
+  return optimize(parameters_optimized);
+}
+
+bool Stomp::getState(StompState& state) const
+{
+  if(current_iteration_ == 0)
+  {
+    return false;
+  }
+
+  state.config = config_;
+  state.iteration = current_iteration_;
+  state.valid_iterations = valid_iterations_;
+  state.parameters_valid_prev = parameters_valid_prev_;
+  state.lowest_cost = current_lowest_cost_;
+  state.parameters_optimized = parameters_optimized_;
+
+  // an interrupted iteration may have overwritten some rollouts, its reused ones are still intact. It is run again
+  // with the noise it drew
+  if(iteration_complete_)
+  {
+    int num_stored = std::max(num_active_rollouts_ - 1,0);
+    state.rollouts.assign(noisy_rollouts_.begin(),noisy_rollouts_.begin() + num_stored);
+    if(!task_->getNoiseState(state.noise_state))
+    {
+      ROS_ERROR("Failed to get the task noise generator state");
+      return false;
+    }
+  }
+  else
+  {
+    state.rollouts.assign(reused_rollouts_.begin(),reused_rollouts_.begin() + num_reused_rollouts_);
+    state.noise_state = noise_state_;
+  }
+
+  return true;
+}
+
+bool Stomp::optimize(Eigen::MatrixXd& parameters_optimized)
+{
+  TraceSpan span("Stomp::optimize","stomp");
   while(current_iteration_ <= config_.num_iterations && runSingleIteration())
   {
 
@@ -258,16 +355,16 @@ bool Stomp::solve(const Eigen::MatrixXd& initial_parameters,
     if(parameters_valid_)
     {
       ROS_DEBUG("Found valid solution, will iterate %i more time(s) ",
-               config_.num_iterations_after_valid - valid_iterations);
+               config_.num_iterations_after_valid - valid_iterations_);
 
-      valid_iterations++;
+      valid_iterations_++;
     }
     else
     {
-      valid_iterations = 0;
+      valid_iterations_ = 0;
     }
 
-    if(valid_iterations > config_.num_iterations_after_valid)
+    if(valid_iterations_ > config_.num_iterations_after_valid)
     {
       break;
     }
@@ -288,7 +385,7 @@ bool Stomp::solve(const Eigen::MatrixXd& initial_parameters,
       ROS_ERROR_STREAM("Stomp was terminated");
   }
 
-  parameters_optimized = parameters_optimized_;
+  parameters_optimized = evaluateTrajectory(parameters_optimized_);
 
   // notifying task
   task_->done(parameters_valid_,current_iteration_,current_lowest_cost_,parameters_optimized);
@@ -302,7 +399,10 @@ bool Stomp::resetVariables()
   parameters_total_cost_ = 0;
   parameters_valid_ = false;
   num_active_rollouts_ = 0;
+  num_reused_rollouts_ = 0;
   current_iteration_ = 0;
+  valid_iterations_ = 0;
+  iteration_complete_ = true;
 
   // verifying configuration
   if(config_.max_rollouts <= config_.num_rollouts)
@@ -311,6 +411,14 @@ bool Stomp::resetVariables()
     config_.max_rollouts = config_.num_rollouts + 1; // one more to accommodate optimized trajectory
   }
 
+  if(config_.num_control_points != 0 && getNumParameters(config_) != config_.num_control_points)
+  {
+    ROS_WARN("'num_control_points' must be greater than %i and less than 'num_timesteps', optimizing all timesteps instead",
+             BSPLINE_DEGREE);
+    config_.num_control_points = 0;
+  }
+  num_parameters_ = getNumParameters(config_);
+
   // noisy rollouts allocation
   int d = config_.num_dimensions;
   num_active_rollouts_ = 0;
@@ -319,27 +427,21 @@ bool Stomp::resetVariables()
 
   // initializing rollout
   Rollout rollout;
-  rollout.noise.resize(d, config_.num_timesteps);
+  rollout.noise.resize(d, num_parameters_);
   rollout.noise.setZero();
 
-  rollout.parameters_noise.resize(d, config_.num_timesteps);
+  rollout.parameters_noise.resize(d, num_parameters_);
   rollout.parameters_noise.setZero();
 
-  rollout.probabilities.resize(d, config_.num_timesteps);
-  rollout.probabilities.setZero();
-
   rollout.full_probabilities.clear();
   rollout.full_probabilities.resize(d);
 
   rollout.full_costs.clear();
   rollout.full_costs.resize(d);
 
-  rollout.control_costs.resize(d, config_.num_timesteps);
+  rollout.control_costs.resize(d);
   rollout.control_costs.setZero();
 
-  rollout.total_costs.resize(d, config_.num_timesteps);
-  rollout.total_costs.setZero();
-
   rollout.state_costs.resize(config_.num_timesteps);
   rollout.state_costs.setZero();
 
@@ -352,67 +454,165 @@ bool Stomp::resetVariables()
   }
 
   // parameter updates
-  parameters_updates_.resize(d, config_.num_timesteps);
+  parameters_updates_.resize(d, num_parameters_);
   parameters_updates_.setZero();
 
-  parameters_control_costs_.resize(d, config_.num_timesteps);
+  parameters_control_costs_.resize(d);
   parameters_control_costs_.setZero();
 
   parameters_state_costs_.resize(config_.num_timesteps);
   parameters_state_costs_.setZero();
 
-  parameters_optimized_.resize(config_.num_dimensions,config_.num_timesteps);
+  parameters_optimized_.resize(config_.num_dimensions,num_parameters_);
   parameters_optimized_.setZero();
 
-  // generate finite difference matrix
+  // generate finite difference and control cost matrices, these are reused when the problem shape was seen before
   start_index_padded_ = FINITE_DIFF_RULE_LENGTH-1;
   num_timesteps_padded_ = config_.num_timesteps + 2*(FINITE_DIFF_RULE_LENGTH-1);
+
+  CostMatricesKey key = std::make_tuple(config_.num_timesteps,config_.num_control_points,config_.delta_t);
+  auto cached = cost_matrices_cache_.find(key);
+  if(cached == cost_matrices_cache_.end())
+  {
+    CostMatrices m;
+    computeCostMatrices(m);
+    cached = cost_matrices_cache_.insert(std::make_pair(key,m)).first;
+  }
+
+  const CostMatrices& m = cached->second;
+  finite_diff_matrix_A_padded_ = m.finite_diff_matrix_A_padded;
+  control_cost_matrix_R_padded_ = m.control_cost_matrix_R_padded;
+  control_cost_matrix_R_ = m.control_cost_matrix_R;
+  inv_control_cost_matrix_R_ = m.inv_control_cost_matrix_R;
+  basis_matrix_ = m.basis_matrix;
+  fit_matrix_ = m.fit_matrix;
+  cost_projection_matrix_ = m.cost_projection_matrix;
+  control_point_cost_matrix_R_ = m.control_point_cost_matrix_R;
+  control_cost_bands_ = m.control_cost_bands;
+
+  min_costs_.setZero(num_parameters_);
+  cost_scales_.setZero(num_parameters_);
+  probability_sums_.setZero(num_parameters_);
+  weighted_noise_sums_.setZero(num_parameters_);
+  parameters_row_.setZero(num_parameters_);
+
+  if(config_.num_control_points > 0)
+  {
+    control_point_state_costs_.setZero(num_parameters_,config_.max_rollouts);
+    parameters_trajectory_.setZero(d,config_.num_timesteps);
+  }
+
+  return true;
+}
+
+void Stomp::computeCostMatrices(CostMatrices& m) const
+{
+  // generate finite difference matrix
   generateFiniteDifferenceMatrix(num_timesteps_padded_,DerivativeOrders::STOMP_ACCELERATION,
-                                 config_.delta_t,finite_diff_matrix_A_padded_);
+                                 config_.delta_t,m.finite_diff_matrix_A_padded);
 
   /* control cost matrix (R = A_transpose * A):
    * Note: Original code multiplies the A product by the time interval.  However this is not
    * what was described in the literature
    */
-  control_cost_matrix_R_padded_ = config_.delta_t*finite_diff_matrix_A_padded_.transpose() * finite_diff_matrix_A_padded_;
-  control_cost_matrix_R_ = control_cost_matrix_R_padded_.block(
+  m.control_cost_matrix_R_padded = config_.delta_t*m.finite_diff_matrix_A_padded.transpose() * m.finite_diff_matrix_A_padded;
+  m.control_cost_matrix_R = m.control_cost_matrix_R_padded.block(
       start_index_padded_,start_index_padded_,config_.num_timesteps,config_.num_timesteps);
-  inv_control_cost_matrix_R_ = control_cost_matrix_R_.fullPivLu().inverse();
+  m.inv_control_cost_matrix_R = m.control_cost_matrix_R.fullPivLu().inverse();
 
   /*
    * Applying scale factor to ensure that max(R^-1)==1
    */
-  double maxVal = std::abs(inv_control_cost_matrix_R_.maxCoeff());
-  control_cost_matrix_R_padded_ *= maxVal;
-  control_cost_matrix_R_ *= maxVal;
-  inv_control_cost_matrix_R_ /= maxVal; // used in computing the minimum control cost initial trajectory
+  double maxVal = std::abs(m.inv_control_cost_matrix_R.maxCoeff());
+  m.control_cost_matrix_R_padded *= maxVal;
+  m.control_cost_matrix_R *= maxVal;
+  m.inv_control_cost_matrix_R /= maxVal; // used in computing the minimum control cost initial trajectory
 
-  return true;
+  // B-spline control point parameterization
+  if(config_.num_control_points > 0)
+  {
+    generateBSplineBasisMatrix(num_parameters_,config_.num_timesteps,m.basis_matrix);
+    m.fit_matrix = (m.basis_matrix * m.basis_matrix.transpose()).llt().solve(m.basis_matrix).transpose();
+
+    // the cost at a control point is the basis weighted average of the state costs it influences
+    m.cost_projection_matrix = m.basis_matrix;
+    for(auto k = 0u; k < num_parameters_; k++)
+    {
+      m.cost_projection_matrix.row(k) /= m.cost_projection_matrix.row(k).sum();
+    }
+
+    // x_cp * B * R * B^T * x_cp^T yields the same control cost as the evaluated trajectory
+    m.control_point_cost_matrix_R = m.basis_matrix * m.control_cost_matrix_R * m.basis_matrix.transpose();
+  }
+
+  // storing the non zero diagonals of the control cost matrix in which the parameters live
+  const Eigen::MatrixXd& R = config_.num_control_points > 0 ? m.control_point_cost_matrix_R : m.control_cost_matrix_R;
+  int bandwidth = 0;
+  for(int k = 1; k < R.cols(); k++)
+  {
+    if(!R.diagonal(k).isZero(0.0))
+    {
+      bandwidth = k;
+    }
+  }
+
+  m.control_cost_bands.setZero(R.rows(),bandwidth + 1);
+  for(int k = 0; k <= bandwidth; k++)
+  {
+    m.control_cost_bands.col(k).head(R.rows() - k) = R.diagonal(k);
+  }
 }
 
-bool Stomp::computeInitialTrajectory(const std::vector<double>& first,const std::vector<double>& last)
+bool Stomp::computeInitialTrajectory(const std::vector<double>& first,const std::vector<double>& last,
+                                     Eigen::MatrixXd& trajectory)
 {
   bool valid = true;
+  trajectory.setZero(config_.num_dimensions,config_.num_timesteps);
 
   switch(config_.initialization_method)
   {
     case TrajectoryInitializations::CUBIC_POLYNOMIAL_INTERPOLATION:
 
-      computeCubicInterpolation(first,last,config_.num_timesteps,config_.delta_t,parameters_optimized_);
+      computeCubicInterpolation(first,last,config_.num_timesteps,config_.delta_t,trajectory);
       break;
     case TrajectoryInitializations::LINEAR_INTERPOLATION:
 
-      computeLinearInterpolation(first,last,config_.num_timesteps,parameters_optimized_);
+      computeLinearInterpolation(first,last,config_.num_timesteps,trajectory);
       break;
     case TrajectoryInitializations::MININUM_CONTROL_COST:
 
-      valid = computeMinCostTrajectory(first,last,control_cost_matrix_R_padded_,inv_control_cost_matrix_R_,parameters_optimized_);
+      valid = computeMinCostTrajectory(first,last,control_cost_matrix_R_padded_,inv_control_cost_matrix_R_,trajectory);
       break;
   }
 
   return valid;
 }
 
+void Stomp::fitParameters(const Eigen::MatrixXd& trajectory,Eigen::MatrixXd& parameters) const
+{
+  if(config_.num_control_points == 0)
+  {
+    parameters = trajectory;
+    return;
+  }
+
+  // the clamped spline passes through its first and last control points
+  parameters = trajectory * fit_matrix_;
+  parameters.col(0) = trajectory.col(0);
+  parameters.col(num_parameters_ - 1) = trajectory.col(config_.num_timesteps - 1);
+}
+
+const Eigen::MatrixXd& Stomp::evaluateTrajectory(const Eigen::MatrixXd& parameters)
+{
+  if(config_.num_control_points == 0)
+  {
+    return parameters;
+  }
+
+  parameters_trajectory_.noalias() = parameters * basis_matrix_;
+  return parameters_trajectory_;
+}
+
 bool Stomp::cancel()
 {
   ROS_WARN("Interrupting STOMP");
@@ -427,21 +627,34 @@ bool Stomp::runSingleIteration()
     return false;
   }
 
+  TraceSpan span("iteration","stomp","iteration",current_iteration_);
+  iteration_complete_ = false;
+
+  // kept for a snapshot taken if the iteration is interrupted
+  if(!task_->getNoiseState(noise_state_))
+  {
+    ROS_ERROR("Failed to get the task noise generator state");
+    return false;
+  }
   bool proceed = generateNoisyRollouts() &&
       computeNoisyRolloutsCosts() &&
       filterNoisyRollouts() &&
       computeProbabilities() &&
       updateParameters() &&
       computeOptimizedCost();
+  iteration_complete_ = proceed;
 
   // notifying end of iteration
-  task_->postIteration(0,config_.num_timesteps,current_iteration_,current_lowest_cost_,parameters_optimized_);
+  TraceSpan post_iteration_span("postIteration","stomp");
+  task_->postIteration(0,config_.num_timesteps,current_iteration_,current_lowest_cost_,evaluateTrajectory(parameters_optimized_));
 
   return proceed;
 }
 
 bool Stomp::generateNoisyRollouts()
 {
+  TraceSpan span("generateNoisyRollouts","stomp");
+
   // calculating number of rollouts to reuse from previous iteration
   std::vector< std::pair<double,int> > rollout_cost_sorter; // Used to sort noisy trajectories in ascending order wrt their total cost
   double h = config_.exponentiated_cost_sensitivity;
@@ -450,6 +663,7 @@ bool Stomp::generateNoisyRollouts()
   int rollouts_generate = config_.num_rollouts;
   int rollouts_total = rollouts_generate + rollouts_stored +1;
   int rollouts_reuse =  rollouts_total < config_.max_rollouts  ? rollouts_stored :  config_.max_rollouts - (rollouts_generate + 1) ; // +1 for optimized params
+  num_reused_rollouts_ = 0;
 
   // selecting least costly rollouts from previous iteration
   if(rollouts_reuse > 0)
@@ -500,6 +714,7 @@ bool Stomp::generateNoisyRollouts()
     {
       noisy_rollouts_[rollouts_generate + r ] = reused_rollouts_[r];
     }
+    num_reused_rollouts_ = rollouts_reuse;
   }
 
   // adding optimized trajectory as the last rollout
@@ -518,7 +733,7 @@ bool Stomp::generateNoisyRollouts()
     }
 
     if(!task_->generateNoisyParameters(parameters_optimized_,
-                                      0,config_.num_timesteps,
+                                      0,num_parameters_,
                                       current_iteration_,r,
                                       noisy_rollouts_[r].parameters_noise,
                                       noisy_rollouts_[r].noise))
@@ -537,6 +752,8 @@ bool Stomp::generateNoisyRollouts()
 
 bool Stomp::filterNoisyRollouts()
 {
+  TraceSpan span("filterNoisyRollouts","stomp");
+
   // apply post noise generation filters
   bool filtered = false;
   for(auto r = 0u ; r < config_.num_rollouts; r++)
@@ -546,7 +763,7 @@ bool Stomp::filterNoisyRollouts()
       return false;
     }
 
-    if(!task_->filterNoisyParameters(0,config_.num_timesteps,current_iteration_,r,noisy_rollouts_[r].parameters_noise,filtered))
+    if(!task_->filterNoisyParameters(0,num_parameters_,current_iteration_,r,noisy_rollouts_[r].parameters_noise,filtered))
     {
       ROS_ERROR_STREAM("Failed to filter noisy parameters");
       return false;
@@ -563,6 +780,8 @@ bool Stomp::filterNoisyRollouts()
 
 bool Stomp::computeNoisyRolloutsCosts()
 {
+  TraceSpan span("computeNoisyRolloutsCosts","stomp");
+
   // computing state and control costs
   bool valid = computeRolloutsStateCosts() && computeRolloutsControlCosts();
 
@@ -577,22 +796,17 @@ bool Stomp::computeNoisyRolloutsCosts()
       Rollout& rollout = noisy_rollouts_[r];
       total_state_cost = rollout.state_costs.sum();
 
-      // Compute control + state cost for each joint
+      // Compute control + state cost for each joint, the per timestep total cost is never stored and
+      // is instead computed as state_costs(t) + control_costs(d) where needed
       total_control_cost = 0;
       double ccost = 0;
       for(auto d = 0u; d < config_.num_dimensions; d++)
       {
-        ccost = rollout.control_costs.row(d).sum();
+        ccost = config_.num_timesteps * rollout.control_costs(d);
         total_control_cost += ccost;
         rollout.full_costs[d] = ccost + total_state_cost;
       }
       rollout.total_cost = total_state_cost + total_control_cost;
-
-      // Compute total cost for each time step
-      for(auto d = 0u; d < config_.num_dimensions; d++)
-      {
-        rollout.total_costs.row(d) = rollout.state_costs.transpose() + rollout.control_costs.row(d);
-      }
     }
   }
 
@@ -604,6 +818,40 @@ bool Stomp::computeRolloutsStateCosts()
 
   bool all_valid = true;
   bool proceed = true;
+  if(task_->supportsNoisyCostsBatch())
+  {
+    if(!proceed_)
+    {
+      return false;
+    }
+
+    batch_trajectories_.resize(config_.num_rollouts);
+    batch_state_costs_.resize(config_.num_rollouts);
+    for(auto r = 0u ; r < config_.num_rollouts; r++)
+    {
+      batch_trajectories_[r] = evaluateTrajectory(noisy_rollouts_[r].parameters_noise);
+      batch_state_costs_[r].swap(noisy_rollouts_[r].state_costs);
+    }
+
+    {
+      TraceSpan span("computeNoisyCostsBatch","rollout");
+      proceed = task_->computeNoisyCostsBatch(batch_trajectories_,0,config_.num_timesteps,current_iteration_,
+                                              batch_state_costs_,all_valid);
+    }
+
+    // the buffers are swapped back so that neither side allocates on the next iteration
+    for(auto r = 0u ; r < config_.num_rollouts; r++)
+    {
+      batch_state_costs_[r].swap(noisy_rollouts_[r].state_costs);
+    }
+
+    if(!proceed)
+    {
+      ROS_ERROR("Trajectory cost computation failed for the batch of %i rollouts.",config_.num_rollouts);
+    }
+    return proceed;
+  }
+
   for(auto r = 0u ; r < config_.num_rollouts; r++)
   {
     if(!proceed_)
@@ -612,8 +860,9 @@ bool Stomp::computeRolloutsStateCosts()
       break;
     }
 
+    TraceSpan span("rollout","rollout","rollout",r);
     Rollout& rollout = noisy_rollouts_[r];
-    if(!task_->computeNoisyCosts(rollout.parameters_noise,0,
+    if(!task_->computeNoisyCosts(evaluateTrajectory(rollout.parameters_noise),0,
                             config_.num_timesteps,
                             current_iteration_,r,
                             rollout.state_costs,all_valid))
@@ -628,24 +877,20 @@ bool Stomp::computeRolloutsStateCosts()
 }
 bool Stomp::computeRolloutsControlCosts()
 {
-  Eigen::ArrayXXd Ax; // accelerations
   for(auto r = 0u ; r < num_active_rollouts_; r++)
   {
     Rollout& rollout = noisy_rollouts_[r];
 
     if(config_.control_cost_weight < MIN_CONTROL_COST_WEIGHT)
     {
-      for(auto d = 0u; d < config_.num_dimensions; d++)
-      {
-        rollout.control_costs.row(d).setConstant(0);
-      }
+      rollout.control_costs.setZero();
     }
     else
     {
       computeParametersControlCosts(rollout.parameters_noise,
                                     config_.delta_t,
                                     config_.control_cost_weight,
-                                    control_cost_matrix_R_,rollout.control_costs);
+                                    control_cost_bands_,parameters_row_,rollout.control_costs);
     }
   }
   return true;
@@ -653,60 +898,58 @@ bool Stomp::computeRolloutsControlCosts()
 
 bool Stomp::computeProbabilities()
 {
-
-  double cost;
+  TraceSpan span("computeProbabilities","stomp");
   double min_cost;
   double max_cost;
   double denom;
-  double numerator;
   double probl_sum = 0.0; // total probability sum of all rollouts for each joint
   const double h = config_.exponentiated_cost_sensitivity;
-  double exponent = 0;
 
-  for (auto d = 0u; d<config_.num_dimensions; ++d)
+  // projecting the state costs onto the control points
+  if(config_.num_control_points > 0)
   {
-
-    for (auto t = 0u; t<config_.num_timesteps; t++)
+    for (auto r = 0u; r<num_active_rollouts_; ++r)
     {
+      control_point_state_costs_.col(r).noalias() = cost_projection_matrix_ * noisy_rollouts_[r].state_costs;
+    }
+  }
 
-      // find min and max cost over all rollouts at timestep 't':
-      min_cost = noisy_rollouts_[0].total_costs(d,t);
-      max_cost = min_cost;
-      for (auto r=0u; r<num_active_rollouts_; ++r)
-      {
-          cost = noisy_rollouts_[r].total_costs(d,t);
-          if (cost < min_cost)
-              min_cost = cost;
-          if (cost > max_cost)
-              max_cost = cost;
-      }
-
-      denom = max_cost - min_cost;
+  // state costs [parameters] of rollout 'r'
+  auto state_costs = [this](int r) -> const double*
+  {
+    return config_.num_control_points > 0 ? control_point_state_costs_.col(r).data() : noisy_rollouts_[r].state_costs.data();
+  };
 
-      // prevent division by zero:
-      if (denom < MIN_COST_DIFFERENCE)
-      {
-        denom = MIN_COST_DIFFERENCE;
-      }
+  const std::size_t n = num_parameters_;
+  for (auto d = 0u; d<config_.num_dimensions; ++d)
+  {
 
-      probl_sum = 0.0;
-      for (auto r = 0u; r<num_active_rollouts_; ++r)
-      {
-        // this is the exponential term in the probability calculation described in the literature
-        exponent = -h*(noisy_rollouts_[r].total_costs(d,t) - min_cost)/denom;
-        noisy_rollouts_[r].probabilities(d,t) = noisy_rollouts_[r].importance_weight *
-            exp(exponent);
+    // find min and max cost over all rollouts at every parameter
+    min_costs_ = Eigen::Map<const Eigen::VectorXd>(state_costs(0),n).array() + noisy_rollouts_[0].control_costs(d);
+    cost_scales_ = min_costs_;
+    for (auto r=1u; r<num_active_rollouts_; ++r)
+    {
+      kernels::updateMinMax(state_costs(r),noisy_rollouts_[r].control_costs(d),n,min_costs_.data(),cost_scales_.data());
+    }
 
-        probl_sum += noisy_rollouts_[r].probabilities(d,t);
-      }
+    // exponent scale -h/(max - min), preventing division by zero
+    cost_scales_ = -h/(cost_scales_ - min_costs_).array().max(MIN_COST_DIFFERENCE);
 
-      // scaling each probability value by the sum of all probabilities corresponding to all rollouts at time "t"
-      for (auto r = 0u; r<num_active_rollouts_; ++r)
-      {
-        noisy_rollouts_[r].probabilities(d,t) /= probl_sum;
-      }
+    // accumulating the probabilities and the probability weighted noise in a single pass
+    probability_sums_.setZero();
+    weighted_noise_sums_.setZero();
+    for (auto r = 0u; r<num_active_rollouts_; ++r)
+    {
+      parameters_row_ = noisy_rollouts_[r].noise.row(d).transpose();
+      kernels::accumulateProbabilities(state_costs(r),noisy_rollouts_[r].control_costs(d),min_costs_.data(),cost_scales_.data(),
+                                       noisy_rollouts_[r].importance_weight,parameters_row_.data(),n,
+                                       probability_sums_.data(),weighted_noise_sums_.data());
     }
 
+    // the convex combination of the noise, scaled by the sum of all probabilities at each parameter
+    kernels::divide(weighted_noise_sums_.data(),probability_sums_.data(),n,weighted_noise_sums_.data());
+    parameters_updates_.row(d) = weighted_noise_sums_.transpose();
+
 
     // computing full probabilities
     min_cost = noisy_rollouts_[0].full_costs[d];
@@ -742,21 +985,10 @@ bool Stomp::computeProbabilities()
 
 bool Stomp::updateParameters()
 {
-  // computing updates from probabilities using convex combination
-  parameters_updates_.setZero();
-  for(auto d = 0u; d < config_.num_dimensions ; d++)
-  {
-
-    for(auto r = 0u; r < num_active_rollouts_; r++)
-    {
-      auto& rollout = noisy_rollouts_[r];
-      parameters_updates_.row(d) +=  (rollout.noise.row(d).array() * rollout.probabilities.row(d).array()).matrix();
-    }
-
-  }
+  TraceSpan span("updateParameters","stomp");
 
   // filtering updates
-  if(!task_->filterParameterUpdates(0,config_.num_timesteps,current_iteration_,parameters_optimized_,parameters_updates_))
+  if(!task_->filterParameterUpdates(0,num_parameters_,current_iteration_,parameters_optimized_,parameters_updates_))
   {
     ROS_ERROR("Updates filtering step failed");
     return false;
@@ -770,6 +1002,7 @@ bool Stomp::updateParameters()
 
 bool Stomp::computeOptimizedCost()
 {
+  TraceSpan span("computeOptimizedCost","stomp");
 
   // control costs
   parameters_total_cost_ = 0;
@@ -778,16 +1011,16 @@ bool Stomp::computeOptimizedCost()
     computeParametersControlCosts(parameters_optimized_,
                                   config_.delta_t,
                                   config_.control_cost_weight,
-                                  control_cost_matrix_R_,
+                                  control_cost_bands_,parameters_row_,
                                   parameters_control_costs_);
 
     // adding all costs
-    parameters_total_cost_ = parameters_control_costs_.rowwise().sum().sum();
+    parameters_total_cost_ = config_.num_timesteps * parameters_control_costs_.sum();
 
   }
 
   // state costs
-  if(task_->computeCosts(parameters_optimized_,
+  if(task_->computeCosts(evaluateTrajectory(parameters_optimized_),
                          0,config_.num_timesteps,current_iteration_,parameters_state_costs_,parameters_valid_))
   {
 
@@ -0,0 +1,200 @@
+/**
+ * @file trace.cpp
+ * @brief This contains a tracer that records timed spans of the planning work in the Chrome trace event format
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stomp_core/trace.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+namespace stomp_core
+{
+
+/**
+ * @brief Writes a string as a JSON string literal
+ * @param out The stream
+ * @param s   The string
+ */
+static void writeJsonString(std::ostream& out, const std::string& s)
+{
+  out << '"';
+  for(char c : s)
+  {
+    switch(c)
+    {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20)
+        {
+          char escaped[8];
+          std::snprintf(escaped,sizeof(escaped),"\\u%04x",c);
+          out << escaped;
+        }
+        else
+        {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+std::atomic<bool> Tracer::enabled_(false);
+
+Tracer::Tracer():
+    num_threads_(0),
+    start_time_(Clock::now()),
+    max_events_(0),
+    num_events_(0),
+    num_dropped_(0)
+{
+
+}
+
+Tracer& Tracer::getInstance()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::start(std::size_t max_events)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // the buffers held only by the tracer belong to threads that have exited
+  buffers_.erase(std::remove_if(buffers_.begin(),buffers_.end(),[](const std::shared_ptr<ThreadBuffer>& b)
+  {
+    return b.use_count() == 1;
+  }),buffers_.end());
+
+  for(auto& b : buffers_)
+  {
+    std::lock_guard<std::mutex> buffer_lock(b->mutex);
+    b->events.clear();
+  }
+
+  max_events_ = max_events;
+  num_events_ = 0;
+  num_dropped_ = 0;
+  start_time_ = Clock::now();
+  enabled_ = true;
+}
+
+void Tracer::stop()
+{
+  enabled_ = false;
+}
+
+void Tracer::record(Event&& event)
+{
+  if(!isEnabled())
+  {
+    return;
+  }
+
+  if(num_events_++ >= max_events_)
+  {
+    num_events_--;
+    num_dropped_++;
+    return;
+  }
+
+  ThreadBuffer& buffer = getThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.events.push_back(std::move(event));
+}
+
+std::size_t Tracer::getNumEvents() const
+{
+  return num_events_;
+}
+
+Tracer::ThreadBuffer& Tracer::getThreadBuffer()
+{
+  static thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if(!buffer)
+  {
+    buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer->thread_id = ++num_threads_;
+    buffers_.push_back(buffer);
+  }
+
+  return *buffer;
+}
+
+bool Tracer::save(const std::string& filename) const
+{
+  auto micros = [](Clock::duration d)
+  {
+    return std::chrono::duration<double,std::micro>(d).count();
+  };
+
+  // writing next to the destination and renaming it so that readers never see a partial file
+  std::string tmp_filename = filename + ".tmp";
+  std::ofstream out(tmp_filename,std::ios::trunc);
+  out.precision(3);
+  out << std::fixed << "{\"traceEvents\":[";
+
+  int pid = static_cast<int>(::getpid());
+  bool first = true;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(const auto& b : buffers_)
+    {
+      std::lock_guard<std::mutex> buffer_lock(b->mutex);
+      for(const auto& e : b->events)
+      {
+        out << (first ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(out,e.name);
+        out << ",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"ts\":" << micros(e.begin - start_time_)
+            << ",\"dur\":" << micros(e.end - e.begin) << ",\"pid\":" << pid << ",\"tid\":" << b->thread_id;
+        if(e.arg_name)
+        {
+          out << ",\"args\":{\"" << e.arg_name << "\":" << e.arg_value << "}";
+        }
+        out << "}";
+        first = false;
+      }
+    }
+  }
+
+  out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << num_dropped_ << "}}\n";
+  out.close();
+  if(!out || std::rename(tmp_filename.c_str(),filename.c_str()) != 0)
+  {
+    ROS_ERROR("Trace file '%s' could not be written",filename.c_str());
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+} /* namespace stomp_core */
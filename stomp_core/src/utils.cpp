@@ -92,6 +92,81 @@ void generateSmoothingMatrix(int num_timesteps,double dt, Eigen::MatrixXd& proje
   }
 }
 
+void generateBSplineBasisMatrix(int num_control_points, int num_time_steps, Eigen::MatrixXd& basis_matrix)
+{
+  const int p = BSPLINE_DEGREE;
+  const int num_knots = num_control_points + p + 1;
+  const int num_segments = num_control_points - p;
+
+  // clamped uniform knot vector over [0, 1]
+  std::vector<double> knots(num_knots,0.0);
+  for(int i = 0; i < num_knots; i++)
+  {
+    if(i <= p)
+    {
+      knots[i] = 0.0;
+    }
+    else if(i >= num_control_points)
+    {
+      knots[i] = 1.0;
+    }
+    else
+    {
+      knots[i] = static_cast<double>(i - p)/num_segments;
+    }
+  }
+
+  basis_matrix = Eigen::MatrixXd::Zero(num_control_points,num_time_steps);
+  std::vector<double> n(num_knots - 1,0.0);
+  for(int t = 0; t < num_time_steps; t++)
+  {
+    double u = num_time_steps > 1 ? static_cast<double>(t)/(num_time_steps - 1) : 0.0;
+
+    // zero degree basis, the last non empty span is closed so that u = 1 maps onto the last control point
+    for(int i = 0; i < num_knots - 1; i++)
+    {
+      n[i] = ((knots[i] <= u && u < knots[i+1]) || (u >= 1.0 && i == num_control_points - 1)) ? 1.0 : 0.0;
+    }
+
+    // Cox-de Boor recursion
+    for(int k = 1; k <= p; k++)
+    {
+      for(int i = 0; i < num_knots - 1 - k; i++)
+      {
+        double left = 0.0;
+        double right = 0.0;
+        double denom = knots[i + k] - knots[i];
+        if(denom > 0.0)
+        {
+          left = (u - knots[i])/denom * n[i];
+        }
+
+        denom = knots[i + k + 1] - knots[i + 1];
+        if(denom > 0.0)
+        {
+          right = (knots[i + k + 1] - u)/denom * n[i + 1];
+        }
+        n[i] = left + right;
+      }
+    }
+
+    for(int i = 0; i < num_control_points; i++)
+    {
+      basis_matrix(i,t) = n[i];
+    }
+  }
+}
+
+int getNumParameters(const StompConfiguration& config)
+{
+  if(config.num_control_points > BSPLINE_DEGREE && config.num_control_points < config.num_timesteps)
+  {
+    return config.num_control_points;
+  }
+
+  return config.num_timesteps;
+}
+
 void differentiate(const Eigen::VectorXd& parameters, DerivativeOrders::DerivativeOrder order,
                           double dt, Eigen::VectorXd& derivatives )
 {
@@ -0,0 +1,115 @@
+/**
+ * @file kernels.cpp
+ * @brief This contains gtest code for the stomp math kernels
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <iostream>
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include "stomp_core/kernels.h"
+
+using namespace stomp_core;
+
+static const std::size_t KERNEL_SIZE = 37;         /**< Array size, not a multiple of any vector width so the tails get tested */
+static const double KERNEL_TOLERANCE = 1e-12;      /**< Relative tolerance between the instruction sets */
+
+/** @brief The outputs of all kernels */
+struct KernelResults
+{
+  Eigen::VectorXd min_values;
+  Eigen::VectorXd max_values;
+  Eigen::VectorXd probability_sums;
+  Eigen::VectorXd weighted_noise_sums;
+  Eigen::VectorXd quotients;
+  Eigen::VectorXd axpy;
+  double weighted_dot;
+};
+
+/** @brief Runs all kernels on the same inputs with the active instruction set */
+static KernelResults runKernels()
+{
+  std::srand(0);
+  Eigen::VectorXd costs = Eigen::VectorXd::Random(KERNEL_SIZE).array() + 1.0;
+  Eigen::VectorXd noise = Eigen::VectorXd::Random(KERNEL_SIZE);
+  Eigen::VectorXd scales = -10.0*(Eigen::VectorXd::Random(KERNEL_SIZE).array() + 1.5);
+
+  KernelResults res;
+  res.min_values = costs;
+  res.max_values = costs;
+  kernels::updateMinMax(noise.data(),0.5,KERNEL_SIZE,res.min_values.data(),res.max_values.data());
+
+  res.probability_sums.setZero(KERNEL_SIZE);
+  res.weighted_noise_sums.setZero(KERNEL_SIZE);
+  kernels::accumulateProbabilities(costs.data(),0.5,res.min_values.data(),scales.data(),0.8,noise.data(),KERNEL_SIZE,
+                                   res.probability_sums.data(),res.weighted_noise_sums.data());
+
+  res.quotients.setZero(KERNEL_SIZE);
+  kernels::divide(res.weighted_noise_sums.data(),res.probability_sums.data(),KERNEL_SIZE,res.quotients.data());
+
+  res.weighted_dot = kernels::weightedDot(scales.data(),costs.data(),noise.data(),KERNEL_SIZE);
+
+  res.axpy = costs;
+  kernels::axpy(-2.0,noise.data(),KERNEL_SIZE,res.axpy.data());
+
+  return res;
+}
+
+/** @brief This tests every supported instruction set against the portable kernels */
+TEST(Kernels,instruction_sets)
+{
+  using namespace kernels::InstructionSets;
+  InstructionSet active = kernels::getInstructionSet();
+  ASSERT_TRUE(kernels::isSupported(active));
+
+  ASSERT_TRUE(kernels::setInstructionSet(SCALAR));
+  KernelResults expected = runKernels();
+
+  // verifying the scalar results
+  std::srand(0);
+  Eigen::VectorXd costs = Eigen::VectorXd::Random(KERNEL_SIZE).array() + 1.0;
+  Eigen::VectorXd noise = Eigen::VectorXd::Random(KERNEL_SIZE);
+  Eigen::VectorXd scales = -10.0*(Eigen::VectorXd::Random(KERNEL_SIZE).array() + 1.5);
+  EXPECT_TRUE(expected.min_values.isApprox(costs.array().min(noise.array() + 0.5).matrix()));
+  EXPECT_TRUE(expected.max_values.isApprox(costs.array().max(noise.array() + 0.5).matrix()));
+  Eigen::VectorXd p = 0.8*((costs.array() + 0.5 - expected.min_values.array())*scales.array()).exp();
+  EXPECT_TRUE(expected.probability_sums.isApprox(p));
+  EXPECT_TRUE(expected.weighted_noise_sums.isApprox(p.cwiseProduct(noise)));
+  EXPECT_TRUE(expected.quotients.isApprox(noise));
+  EXPECT_NEAR(expected.weighted_dot,scales.cwiseProduct(costs).dot(noise),KERNEL_TOLERANCE*std::abs(expected.weighted_dot));
+  EXPECT_TRUE(expected.axpy.isApprox(costs - 2.0*noise));
+
+  for(auto s : {SSE2, AVX2, AVX512})
+  {
+    if(!kernels::setInstructionSet(s))
+    {
+      std::cout<<kernels::toString(s)<<" is not supported, skipping\n";
+      continue;
+    }
+
+    KernelResults res = runKernels();
+    EXPECT_TRUE(res.min_values.isApprox(expected.min_values,KERNEL_TOLERANCE))<<kernels::toString(s);
+    EXPECT_TRUE(res.max_values.isApprox(expected.max_values,KERNEL_TOLERANCE))<<kernels::toString(s);
+    EXPECT_TRUE(res.probability_sums.isApprox(expected.probability_sums,KERNEL_TOLERANCE))<<kernels::toString(s);
+    EXPECT_TRUE(res.weighted_noise_sums.isApprox(expected.weighted_noise_sums,KERNEL_TOLERANCE))<<kernels::toString(s);
+    EXPECT_TRUE(res.quotients.isApprox(expected.quotients,KERNEL_TOLERANCE))<<kernels::toString(s);
+    EXPECT_TRUE(res.axpy.isApprox(expected.axpy,KERNEL_TOLERANCE))<<kernels::toString(s);
+    EXPECT_NEAR(res.weighted_dot,expected.weighted_dot,KERNEL_TOLERANCE*std::abs(expected.weighted_dot))<<kernels::toString(s);
+  }
+
+  kernels::setInstructionSet(active);
+}
@@ -24,6 +24,9 @@
  * limitations under the License.
  */
 #include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
 #include <Eigen/Dense>
 #include <gtest/gtest.h>
 #include "stomp_core/stomp.h"
@@ -161,6 +164,11 @@ protected:
                               int iteration_number,
                               Eigen::MatrixXd& updates)
   {
+    // updates are sized by the number of optimized parameters which may differ from the timesteps
+    if(smoothing_M_.cols() != updates.cols())
+    {
+      generateSmoothingMatrix(updates.cols(),1.0,smoothing_M_);
+    }
 
     for(auto d = 0u; d < updates.rows(); d++)
     {
@@ -440,3 +448,321 @@ TEST(Stomp3DOF,solve_60_timesteps)
   std::cout<<"Differences"<<"\n"<<toString(diff)<<line_separator;
 }
 
+
+/** @brief This tests the Stomp solve method with a non zero control cost weight */
+TEST(Stomp3DOF,solve_control_cost_weight)
+{
+  Trajectory trajectory_bias;
+  interpolate(START_POS,END_POS,NUM_TIMESTEPS,trajectory_bias);
+  TaskPtr task(new DummyTask(trajectory_bias,BIAS_THRESHOLD,STD_DEV));
+
+  StompConfiguration config = create3DOFConfiguration();
+  config.control_cost_weight = 0.1;
+  config.exponentiated_cost_sensitivity = 10.0;
+  Stomp stomp(config,task);
+
+  Trajectory optimized;
+  stomp.solve(START_POS,END_POS,optimized);
+
+  EXPECT_EQ(optimized.rows(),NUM_DIMENSIONS);
+  EXPECT_EQ(optimized.cols(),NUM_TIMESTEPS);
+  EXPECT_TRUE(compareDiff(optimized,trajectory_bias,BIAS_THRESHOLD));
+}
+
+/** @brief This tests the B-spline basis matrix used by the control point parameterization */
+TEST(Stomp3DOF,bspline_basis_matrix)
+{
+  int num_control_points = 8;
+  Eigen::MatrixXd basis;
+  generateBSplineBasisMatrix(num_control_points,NUM_TIMESTEPS,basis);
+
+  EXPECT_EQ(basis.rows(),num_control_points);
+  EXPECT_EQ(basis.cols(),NUM_TIMESTEPS);
+
+  // partition of unity
+  for(auto t = 0u; t < NUM_TIMESTEPS; t++)
+  {
+    EXPECT_NEAR(basis.col(t).sum(),1.0,1e-10);
+  }
+
+  // the curve is clamped to the first and last control points
+  EXPECT_NEAR(basis(0,0),1.0,1e-10);
+  EXPECT_NEAR(basis(num_control_points - 1,NUM_TIMESTEPS - 1),1.0,1e-10);
+}
+
+/** @brief This tests the Stomp solve method when optimizing B-spline control points */
+TEST(Stomp3DOF,solve_control_points)
+{
+  Trajectory trajectory_bias;
+  interpolate(START_POS,END_POS,NUM_TIMESTEPS,trajectory_bias);
+  TaskPtr task(new DummyTask(trajectory_bias,BIAS_THRESHOLD,STD_DEV));
+
+  StompConfiguration config = create3DOFConfiguration();
+  config.num_control_points = 8;
+  config.exponentiated_cost_sensitivity = 10.0;
+  Stomp stomp(config,task);
+
+  Trajectory optimized;
+  stomp.solve(START_POS,END_POS,optimized);
+
+  EXPECT_EQ(optimized.rows(),NUM_DIMENSIONS);
+  EXPECT_EQ(optimized.cols(),NUM_TIMESTEPS);
+  EXPECT_TRUE(compareDiff(optimized,trajectory_bias,BIAS_THRESHOLD));
+}
+
+/**
+ * @brief A dummy task that draws its noise from its own random generator and cancels the optimization either at the end
+ * of an iteration or while evaluating one of its rollouts
+ */
+class CancellingTask: public DummyTask
+{
+public:
+  CancellingTask(const Trajectory& parameters_bias,
+                 const std::vector<double>& bias_thresholds,
+                 const std::vector<double>& std_dev,
+                 int cancel_iteration,
+                 int cancel_rollout = -1):
+                   DummyTask(parameters_bias,bias_thresholds,std_dev),
+                   stomp_(nullptr),
+                   cancel_iteration_(cancel_iteration),
+                   cancel_rollout_(cancel_rollout)
+  {
+
+  }
+
+  bool generateNoisyParameters(const Eigen::MatrixXd& parameters,
+                               std::size_t start_timestep,
+                               std::size_t num_timesteps,
+                               int iteration_number,
+                               int rollout_number,
+                               Eigen::MatrixXd& parameters_noise,
+                               Eigen::MatrixXd& noise) override
+  {
+    std::uniform_real_distribution<double> distribution(-1.0,1.0);
+    for(std::size_t d = 0; d < parameters.rows(); d++)
+    {
+      for(std::size_t t = 0; t < parameters.cols(); t++)
+      {
+        noise(d,t) = distribution(generator_)*std_dev_[d];
+      }
+    }
+
+    parameters_noise = parameters + noise;
+    noise_sums_[iteration_number] += noise.sum();
+    return true;
+  }
+
+  bool computeNoisyCosts(const Trajectory& parameters,
+                         std::size_t start_timestep,
+                         std::size_t num_timesteps,
+                         int iteration_number,
+                         int rollout_number,
+                         Eigen::VectorXd& costs,
+                         bool& validity) override
+  {
+    if(stomp_ && iteration_number == cancel_iteration_ && rollout_number == cancel_rollout_)
+    {
+      stomp_->cancel();
+    }
+
+    return DummyTask::computeNoisyCosts(parameters,start_timestep,num_timesteps,iteration_number,rollout_number,costs,
+                                        validity);
+  }
+
+  void postIteration(std::size_t start_timestep,
+                     std::size_t num_timesteps,int iteration_number,double cost,const Eigen::MatrixXd& parameters) override
+  {
+    if(stomp_ && iteration_number == cancel_iteration_ && cancel_rollout_ < 0)
+    {
+      stomp_->cancel();
+    }
+  }
+
+  bool getNoiseState(std::string& state) const override
+  {
+    std::ostringstream stream;
+    stream << generator_;
+    state = stream.str();
+    return true;
+  }
+
+  bool setNoiseState(const std::string& state) override
+  {
+    std::istringstream stream(state);
+    stream >> generator_;
+    return !stream.fail();
+  }
+
+  Stomp* stomp_;            /**< The optimizer to cancel */
+  int cancel_iteration_;    /**< The iteration at which the optimization is cancelled */
+  int cancel_rollout_;      /**< The rollout whose evaluation cancels the optimization, -1 to cancel after the iteration */
+  std::mt19937 generator_;  /**< The generator the noise is drawn from */
+  std::map<int,double> noise_sums_; /**< The sum of the noise drawn in each iteration */
+};
+
+/** @brief The outcome of an optimization that was cancelled and resumed, along with the uninterrupted one */
+struct ResumedOptimization
+{
+  Trajectory expected;                          /**< The trajectory of the uninterrupted optimization */
+  Trajectory optimized;                         /**< The trajectory of the resumed optimization */
+  StompState state;                             /**< The snapshot of the cancelled optimization */
+  std::map<int,double> expected_noise_sums;     /**< The noise drawn in each iteration of the uninterrupted optimization */
+  std::map<int,double> resumed_noise_sums;      /**< The noise drawn in each iteration of the resumed optimization */
+  bool resumed;                                 /**< Whether the resumed optimization succeeded */
+};
+
+/**
+ * @brief Cancels an optimization and resumes it from its snapshot in a new optimizer with a new task
+ * @param config            The configuration of the optimization
+ * @param cancel_iteration  The iteration at which the optimization is cancelled
+ * @param cancel_rollout    The rollout whose evaluation cancels the optimization, -1 to cancel after the iteration
+ * @return The outcome
+ */
+ResumedOptimization cancelAndResume(const StompConfiguration& config,int cancel_iteration,int cancel_rollout)
+{
+  Trajectory trajectory_bias;
+  interpolate(START_POS,END_POS,NUM_TIMESTEPS,trajectory_bias);
+  ResumedOptimization outcome;
+
+  // uninterrupted
+  {
+    std::shared_ptr<CancellingTask> task(new CancellingTask(trajectory_bias,BIAS_THRESHOLD,STD_DEV,-1));
+    Stomp stomp(config,task);
+    stomp.solve(START_POS,END_POS,outcome.expected);
+    outcome.expected_noise_sums = task->noise_sums_;
+  }
+
+  // cancelled
+  {
+    std::shared_ptr<CancellingTask> task(new CancellingTask(trajectory_bias,BIAS_THRESHOLD,STD_DEV,cancel_iteration,
+                                                            cancel_rollout));
+    Stomp stomp(config,task);
+    EXPECT_FALSE(stomp.getState(outcome.state));
+
+    task->stomp_ = &stomp;
+    Trajectory cancelled;
+    stomp.solve(START_POS,END_POS,cancelled);
+    EXPECT_TRUE(stomp.getState(outcome.state));
+  }
+
+  // resumed by a new optimizer whose task starts with a fresh generator
+  std::shared_ptr<CancellingTask> task(new CancellingTask(trajectory_bias,BIAS_THRESHOLD,STD_DEV,-1));
+  Stomp stomp(config,task);
+  outcome.resumed = stomp.resume(outcome.state,outcome.optimized);
+  outcome.resumed_noise_sums = task->noise_sums_;
+  return outcome;
+}
+
+/** @brief This tests that resuming an optimization cancelled between iterations matches an uninterrupted one */
+TEST(Stomp3DOF,resume_from_state)
+{
+  StompConfiguration config = create3DOFConfiguration();
+  config.num_iterations_after_valid = 5;
+  config.max_rollouts = 30;
+
+  const int cancel_iteration = 3;
+  ResumedOptimization outcome = cancelAndResume(config,cancel_iteration,-1);
+
+  EXPECT_TRUE(outcome.resumed);
+  EXPECT_EQ(outcome.state.iteration,cancel_iteration + 1);
+  EXPECT_EQ(outcome.state.rollouts.size(),config.max_rollouts - 1);
+  EXPECT_FALSE(outcome.state.noise_state.empty());
+
+  // the resumed optimization draws the same noise in the remaining iterations
+  ASSERT_FALSE(outcome.resumed_noise_sums.empty());
+  EXPECT_EQ(outcome.resumed_noise_sums.begin()->first,cancel_iteration + 1);
+  for(const auto& n : outcome.resumed_noise_sums)
+  {
+    EXPECT_EQ(n.second,outcome.expected_noise_sums[n.first]);
+  }
+
+  ASSERT_EQ(outcome.optimized.rows(),outcome.expected.rows());
+  ASSERT_EQ(outcome.optimized.cols(),outcome.expected.cols());
+  EXPECT_TRUE(outcome.optimized.isApprox(outcome.expected,1e-12));
+}
+
+/** @brief This tests that resuming an optimization cancelled during an iteration runs it again with the same noise */
+TEST(Stomp3DOF,resume_interrupted_iteration)
+{
+  StompConfiguration config = create3DOFConfiguration();
+  config.num_iterations_after_valid = 5;
+  config.max_rollouts = 30;
+
+  const int cancel_iteration = 3;
+  ResumedOptimization outcome = cancelAndResume(config,cancel_iteration,2);
+
+  EXPECT_TRUE(outcome.resumed);
+  EXPECT_EQ(outcome.state.iteration,cancel_iteration);
+
+  ASSERT_FALSE(outcome.resumed_noise_sums.empty());
+  EXPECT_EQ(outcome.resumed_noise_sums.begin()->first,cancel_iteration);
+  for(const auto& n : outcome.resumed_noise_sums)
+  {
+    EXPECT_EQ(n.second,outcome.expected_noise_sums[n.first]);
+  }
+
+  ASSERT_EQ(outcome.optimized.rows(),outcome.expected.rows());
+  ASSERT_EQ(outcome.optimized.cols(),outcome.expected.cols());
+  EXPECT_TRUE(outcome.optimized.isApprox(outcome.expected,1e-12));
+}
+
+/** @brief A dummy task that evaluates the noisy rollouts of an iteration in batches */
+class BatchTask: public DummyTask
+{
+public:
+  BatchTask(const Trajectory& parameters_bias,
+            const std::vector<double>& bias_thresholds,
+            const std::vector<double>& std_dev):
+              DummyTask(parameters_bias,bias_thresholds,std_dev),
+              num_batches_(0),
+              batch_size_(0)
+  {
+
+  }
+
+  bool supportsNoisyCostsBatch() const override
+  {
+    return true;
+  }
+
+  bool computeNoisyCostsBatch(const std::vector<Eigen::MatrixXd>& parameters,
+                              std::size_t start_timestep,
+                              std::size_t num_timesteps,
+                              int iteration_number,
+                              std::vector<Eigen::VectorXd>& costs,
+                              bool& validity) override
+  {
+    num_batches_++;
+    batch_size_ = parameters.size();
+    return DummyTask::computeNoisyCostsBatch(parameters,start_timestep,num_timesteps,iteration_number,costs,validity);
+  }
+
+  int num_batches_;           /**< The number of batches evaluated */
+  std::size_t batch_size_;    /**< The number of rollouts in the last batch */
+};
+
+/** @brief This tests that evaluating the rollouts in batches matches evaluating them one at a time */
+TEST(Stomp3DOF,solve_noisy_costs_batch)
+{
+  Trajectory trajectory_bias;
+  interpolate(START_POS,END_POS,NUM_TIMESTEPS,trajectory_bias);
+
+  StompConfiguration config = create3DOFConfiguration();
+
+  Trajectory expected;
+  {
+    TaskPtr task(new DummyTask(trajectory_bias,BIAS_THRESHOLD,STD_DEV));
+    Stomp stomp(config,task);
+    EXPECT_TRUE(stomp.solve(START_POS,END_POS,expected));
+  }
+
+  std::shared_ptr<BatchTask> task(new BatchTask(trajectory_bias,BIAS_THRESHOLD,STD_DEV));
+  Stomp stomp(config,task);
+  Trajectory optimized;
+  EXPECT_TRUE(stomp.solve(START_POS,END_POS,optimized));
+  EXPECT_GT(task->num_batches_,0);
+  EXPECT_EQ(task->batch_size_,config.num_rollouts);
+  ASSERT_EQ(optimized.rows(),expected.rows());
+  ASSERT_EQ(optimized.cols(),expected.cols());
+  EXPECT_TRUE(optimized.isApprox(expected,1e-12));
+}
@@ -0,0 +1,142 @@
+/**
+ * @file trace.cpp
+ * @brief This contains gtest code for the Chrome trace event tracer
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <gtest/gtest.h>
+#include "stomp_core/trace.h"
+
+using namespace stomp_core;
+
+static const int NUM_TRACE_THREADS = 4;            /**< Number of threads recording spans at the same time */
+static const int NUM_THREAD_SPANS = 25;            /**< Number of spans recorded by each thread */
+
+/**
+ * @brief Counts the occurrences of a string
+ * @param text    The text searched
+ * @param pattern The string to count
+ * @return The number of occurrences
+ */
+static std::size_t countOccurrences(const std::string& text, const std::string& pattern)
+{
+  std::size_t count = 0;
+  for(std::size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern,pos + pattern.size()))
+  {
+    count++;
+  }
+  return count;
+}
+
+/**
+ * @brief Saves the recorded spans and reads the file back
+ * @return The file contents
+ */
+static std::string saveTrace()
+{
+  std::string filename = testing::TempDir() + "stomp_trace_test.json";
+  EXPECT_TRUE(Tracer::getInstance().save(filename));
+
+  std::ifstream in(filename);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  std::remove(filename.c_str());
+  return contents.str();
+}
+
+/** @brief This tests that nothing is recorded while tracing is stopped */
+TEST(Trace,stopped)
+{
+  Tracer& tracer = Tracer::getInstance();
+  tracer.start();
+  tracer.stop();
+  {
+    TraceSpan span("stopped","test");
+    EXPECT_FALSE(span.isActive());
+  }
+
+  EXPECT_EQ(tracer.getNumEvents(),0);
+  EXPECT_EQ(countOccurrences(saveTrace(),"\"ph\":\"X\""),0);
+}
+
+/** @brief This tests the spans recorded by several threads at the same time */
+TEST(Trace,threads)
+{
+  Tracer& tracer = Tracer::getInstance();
+  tracer.start();
+
+  std::vector<std::thread> threads;
+  for(int t = 0; t < NUM_TRACE_THREADS; t++)
+  {
+    threads.emplace_back([]()
+    {
+      for(int i = 0; i < NUM_THREAD_SPANS; i++)
+      {
+        TraceSpan span("rollout","test","rollout",i);
+      }
+    });
+  }
+
+  {
+    TraceSpan span("quoted \"name\"","test");
+    EXPECT_TRUE(span.isActive());
+    for(auto& t : threads)
+    {
+      t.join();
+    }
+  }
+  tracer.stop();
+
+  EXPECT_EQ(tracer.getNumEvents(),NUM_TRACE_THREADS*NUM_THREAD_SPANS + 1);
+
+  std::string trace = saveTrace();
+  EXPECT_EQ(trace.find("{\"traceEvents\":["),0);
+  EXPECT_EQ(countOccurrences(trace,"\"name\":\"rollout\""),NUM_TRACE_THREADS*NUM_THREAD_SPANS);
+  EXPECT_EQ(countOccurrences(trace,"\"args\":{\"rollout\":" + std::to_string(NUM_THREAD_SPANS - 1) + "}"),
+            NUM_TRACE_THREADS);
+  EXPECT_EQ(countOccurrences(trace,"\"name\":\"quoted \\\"name\\\"\""),1);
+
+  // each thread has its own track
+  std::set<std::string> thread_ids;
+  for(std::size_t pos = trace.find("\"tid\":"); pos != std::string::npos; pos = trace.find("\"tid\":",pos + 1))
+  {
+    thread_ids.insert(trace.substr(pos,trace.find_first_of(",}",pos) - pos));
+  }
+  EXPECT_EQ(thread_ids.size(),NUM_TRACE_THREADS + 1);
+}
+
+/** @brief This tests that the spans beyond the maximum are dropped */
+TEST(Trace,max_events)
+{
+  Tracer& tracer = Tracer::getInstance();
+  tracer.start(10);
+  for(int i = 0; i < 15; i++)
+  {
+    TraceSpan span("span","test");
+  }
+  tracer.stop();
+
+  EXPECT_EQ(tracer.getNumEvents(),10);
+
+  std::string trace = saveTrace();
+  EXPECT_EQ(countOccurrences(trace,"\"ph\":\"X\""),10);
+  EXPECT_NE(trace.find("\"dropped_events\":5"),std::string::npos);
+}
@@ -29,6 +29,7 @@
 #include <Eigen/Sparse>
 #include <moveit/robot_model/robot_model.h>
 #include "stomp_moveit/cost_functions/stomp_cost_function.h"
+#include "stomp_moveit/utils/robot_state_pool.h"
 
 namespace stomp_moveit
 {
@@ -111,6 +112,8 @@ public:
 
   virtual void done(bool success,int total_iterations,double final_cost,const Eigen::MatrixXd& parameters) override;
 
+  virtual void getValidityCertificates(std::vector<ValidityCertificate>& certificates) const override;
+
 protected:
 
   /**
@@ -128,6 +131,7 @@ protected:
   // robot details
   std::string group_name_;
   moveit::core::RobotModelConstPtr robot_model_ptr_;
+  utils::RobotStatePoolPtr state_pool_;    /**< @brief Hands out the robot states reused across requests */
   moveit::core::RobotStatePtr robot_state_;
 
   // planning context information
@@ -151,6 +155,10 @@ protected:
   // intermediate collision check support
   std::array<moveit::core::RobotStatePtr,3 > intermediate_coll_states_;   /**< @brief Used in checking collisions between to consecutive poses*/
 
+  // validity certificates
+  std::array<ValidityCertificate,2> certificates_;  /**< @brief The last two collision free optimized trajectories, the optimizer may revert to the older one */
+  std::size_t num_certificates_;
+
 };
 
 } /* namespace cost_functions */
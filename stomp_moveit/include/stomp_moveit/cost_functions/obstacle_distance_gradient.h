@@ -29,6 +29,7 @@
 
 #include <stomp_moveit/cost_functions/stomp_cost_function.h>
 #include <array>
+#include <stomp_moveit/utils/robot_state_pool.h>
 
 namespace stomp_moveit
 {
@@ -123,6 +124,7 @@ protected:
   // robot details
   std::string group_name_;
   moveit::core::RobotModelConstPtr robot_model_ptr_;
+  utils::RobotStatePoolPtr state_pool_;    /**< @brief Hands out the robot states reused across requests */
   moveit::core::RobotStatePtr robot_state_;
 
   // intermediate collision check support
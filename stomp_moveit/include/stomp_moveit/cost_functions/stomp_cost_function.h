@@ -43,6 +43,17 @@ namespace cost_functions
 class StompCostFunction;
 typedef std::shared_ptr<StompCostFunction> StompCostFunctionPtr;
 
+/**
+ * @brief Records that a trajectory was found collision free, so that the planner does not check its waypoints again.
+ */
+struct ValidityCertificate
+{
+  planning_scene::PlanningSceneConstPtr planning_scene;   /**< @brief The planning scene the waypoints were checked against */
+  Eigen::MatrixXd waypoints;                              /**< @brief The checked waypoints [num_dimensions x num_timesteps] */
+  double segment_resolution;                              /**< @brief The largest joint move between the checked states of each
+                                                                      segment, zero when only the waypoints were checked */
+};
+
 /**
  * @class stomp_moveit::cost_functions::StompCostFunction
  * @brief The interface class for the STOMP cost functions.
@@ -158,6 +169,16 @@ public:
     return -1;
   }
 
+  /**
+   * @brief Called by the planner once the optimization is done in order to retrieve the trajectories that this cost
+   *        function found collision free, the default implementation provides none.
+   * @param certificates  The certificates are appended to this array.
+   */
+  virtual void getValidityCertificates(std::vector<ValidityCertificate>& certificates) const
+  {
+
+  }
+
 
 protected:
 
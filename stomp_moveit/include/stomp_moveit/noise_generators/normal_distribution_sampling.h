@@ -28,6 +28,7 @@
 
 #include <stomp_moveit/noise_generators/stomp_noise_generator.h>
 #include <stomp_moveit/utils/multivariate_gaussian.h>
+#include <map>
 
 namespace stomp_moveit
 {
@@ -110,6 +111,7 @@ protected:
 
   // random noise generation
   std::vector<utils::MultivariateGaussianPtr> rand_generators_;
+  std::map<std::size_t,std::vector<utils::MultivariateGaussianPtr> > rand_generators_cache_; /**< @brief The generators created for each number of timesteps */
   Eigen::VectorXd raw_noise_;
   std::vector<double> stddev_;
 
@@ -32,6 +32,7 @@
 #include <visualization_msgs/MarkerArray.h>
 #include <geometry_msgs/Point.h>
 #include <stomp_moveit/noisy_filters/stomp_noisy_filter.h>
+#include <stomp_moveit/utils/robot_state_pool.h>
 
 namespace stomp_moveit
 {
@@ -102,6 +103,7 @@ protected:
   // robot
   std::string group_name_;
   moveit::core::RobotModelConstPtr robot_model_;
+  utils::RobotStatePoolPtr state_pool_;    /**< @brief Hands out the robot states reused across requests */
   moveit::core::RobotStatePtr state_;
 
   // ros comm
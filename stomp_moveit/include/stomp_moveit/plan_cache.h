@@ -0,0 +1,157 @@
+/**
+ * @file plan_cache.h
+ * @brief This defines a cache of the plans found for repeated motion plan requests
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef STOMP_MOVEIT_PLAN_CACHE_H_
+#define STOMP_MOVEIT_PLAN_CACHE_H_
+
+#include <moveit/planning_interface/planning_interface.h>
+#include <moveit_msgs/RobotTrajectory.h>
+#include <XmlRpcValue.h>
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace stomp_moveit
+{
+
+class PlanCache;
+typedef std::shared_ptr<PlanCache> PlanCachePtr;
+
+/**
+ * @class stomp_moveit::PlanCache
+ * @brief A least recently used cache of the trajectories found for a planning group.
+ *
+ * Requests match when their start joint values, quantized to a configurable resolution, their goal, path and seed
+ * constraints, their planner id and the contents of the planning scene other than the octomap are the same. The cache is emptied
+ * when a request is made against a planning scene with different contents. This class is thread-safe.
+ */
+class PlanCache
+{
+public:
+
+  /** @brief Identifies a request */
+  struct Key
+  {
+    std::vector<long> start;        /**< @brief The quantized start joint values */
+    std::size_t request_hash;       /**< @brief Hash of the goal, path and seed constraints with quantized joint values */
+    std::size_t scene_hash;         /**< @brief Hash of the planning scene contents except the octomap */
+
+    bool operator<(const Key& other) const;
+  };
+
+  /**
+   * @brief Constructor
+   * @param group   The planning group
+   * @param config  The 'plan_cache' parameter of the group containing 'capacity' and optionally 'joint_resolution'
+   */
+  PlanCache(const std::string& group, const XmlRpc::XmlRpcValue& config);
+
+  /**
+   * @brief Computes the key of a request
+   * @param planning_scene  The planning scene
+   * @param req             The motion plan request
+   * @param key             The computed key
+   * @return True if succeeded, otherwise false.
+   */
+  bool computeKey(const planning_scene::PlanningSceneConstPtr& planning_scene, const moveit_msgs::MotionPlanRequest& req,
+                  Key& key);
+
+  /**
+   * @brief Looks up a trajectory and marks it as the most recently used
+   * @param key         The request key
+   * @param trajectory  The cached trajectory
+   * @return True if found, otherwise false.
+   */
+  bool lookup(const Key& key, moveit_msgs::RobotTrajectory& trajectory);
+
+  /**
+   * @brief Adds a trajectory, evicting the least recently used one when full
+   * @param key         The request key
+   * @param trajectory  The trajectory
+   */
+  void insert(const Key& key, const moveit_msgs::RobotTrajectory& trajectory);
+
+  /**
+   * @brief Removes a trajectory
+   * @param key The request key
+   */
+  void erase(const Key& key);
+
+protected:
+
+  typedef std::list< std::pair<Key, moveit_msgs::RobotTrajectory> > EntryList;
+
+  std::string group_;
+  std::size_t capacity_;
+  double joint_resolution_;                       /**< @brief The joint value difference below which requests match */
+
+  std::mutex mutex_;
+  std::size_t scene_hash_;                        /**< @brief The hash of the scene of the cached entries */
+  EntryList entries_;                             /**< @brief The entries from the most to the least recently used */
+  std::map<Key, EntryList::iterator> index_;
+};
+
+/**
+ * @class stomp_moveit::PlanCacheContext
+ * @brief A planning context that either returns a cached trajectory or solves with a planner and caches its trajectory.
+ */
+class PlanCacheContext: public planning_interface::PlanningContext
+{
+public:
+  /**
+   * @brief Constructor for a cache hit
+   * @param name        The context name
+   * @param group       The planning group
+   * @param trajectory  The cached trajectory, already validated against the planning scene
+   */
+  PlanCacheContext(const std::string& name, const std::string& group, robot_trajectory::RobotTrajectoryPtr trajectory);
+
+  /**
+   * @brief Constructor for a cache miss
+   * @param planner The planning context that solves the request
+   * @param cache   The cache where the trajectory is stored
+   * @param key     The request key
+   */
+  PlanCacheContext(planning_interface::PlanningContextPtr planner, PlanCachePtr cache, const PlanCache::Key& key);
+
+  virtual ~PlanCacheContext();
+
+  virtual bool solve(planning_interface::MotionPlanResponse &res) override;
+  virtual bool solve(planning_interface::MotionPlanDetailedResponse &res) override;
+  virtual bool terminate() override;
+  virtual void clear() override;
+
+protected:
+
+  /**
+   * @brief Stores the trajectory of a successful response
+   * @param trajectory The planned trajectory
+   */
+  void store(const robot_trajectory::RobotTrajectoryPtr& trajectory);
+
+  robot_trajectory::RobotTrajectoryPtr trajectory_;
+  planning_interface::PlanningContextPtr planner_;
+  PlanCachePtr cache_;
+  PlanCache::Key key_;
+};
+
+} /* namespace stomp_moveit */
+
+#endif /* STOMP_MOVEIT_PLAN_CACHE_H_ */
@@ -0,0 +1,218 @@
+/**
+ * @file planning_statistics.h
+ * @brief This defines the latency and outcome statistics of the motion plan requests solved by STOMP
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef STOMP_MOVEIT_PLANNING_STATISTICS_H_
+#define STOMP_MOVEIT_PLANNING_STATISTICS_H_
+
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace stomp_moveit
+{
+
+class PlanningStatistics;
+typedef std::shared_ptr<PlanningStatistics> PlanningStatisticsPtr;
+
+/**
+ * @class stomp_moveit::Histogram
+ * @brief Counts positive values in logarithmic bins, 10 per decade from 1e-4 to 1e4, so that the percentiles are within
+ * about 25% of the exact ones regardless of the value scale. The values outside of the range fall into the first and last bins.
+ */
+class Histogram
+{
+public:
+  Histogram();
+
+  /**
+   * @brief Adds a value
+   * @param value The value
+   */
+  void add(double value);
+
+  /**
+   * @brief Getter for the number of values added
+   * @return The number of values
+   */
+  std::size_t getCount() const;
+
+  /**
+   * @brief Getter for the mean of the values added
+   * @return The mean, zero if none
+   */
+  double getMean() const;
+
+  /**
+   * @brief Getter for the largest value added
+   * @return The largest value, zero if none
+   */
+  double getMax() const;
+
+  /**
+   * @brief Estimates a percentile as the upper edge of the bin that contains it, clamped to the range of the values added
+   * @param p The percentile within [0, 1]
+   * @return The estimated value, zero if none
+   */
+  double getPercentile(double p) const;
+
+protected:
+
+  std::vector<std::size_t> bins_;
+  std::size_t count_;
+  double sum_;
+  double min_;
+  double max_;
+};
+
+/**
+ * @class stomp_moveit::PlanningStatistics
+ * @brief Accumulates the duration of each phase of the solved requests, their optimization iterations and their outcome
+ * for each planning group and profile. The total latency may be given an objective, the fraction of the requests
+ * solved within it is then reported against the target percentile. This class is thread-safe.
+ */
+class PlanningStatistics
+{
+public:
+
+  /** @brief The phases of a request */
+  enum Phase
+  {
+    SETUP = 0,                  /**< @brief The seed lookup and the optimization task setup */
+    OPTIMIZATION,               /**< @brief The Stomp optimization */
+    TIME_PARAMETERIZATION,      /**< @brief The conversion of the optimized parameters into a timed trajectory */
+    VALIDATION,                 /**< @brief The check of the trajectory against the planning scene */
+    TOTAL,                      /**< @brief The whole request */
+    NUM_PHASES
+  };
+
+  /** @brief The measurements of a request */
+  struct Sample
+  {
+    std::array<double,NUM_PHASES> durations;    /**< @brief The seconds spent in each phase, zero for the phases not reached */
+    int iterations = 0;                         /**< @brief The optimization iterations */
+    bool success = false;                       /**< @brief Whether a valid trajectory was returned */
+  };
+
+  /**
+   * @brief Times the phases of a request and records them on destruction, so that the requests that return early are
+   * recorded as failures. Does nothing when created without statistics.
+   */
+  class Recorder
+  {
+  public:
+    /**
+     * @brief Constructor, starts timing the request
+     * @param statistics  The statistics the request is recorded into, may be null
+     * @param group       The planning group
+     * @param profile     The planning profile
+     */
+    Recorder(const PlanningStatisticsPtr& statistics, const std::string& group, const std::string& profile);
+    ~Recorder();
+
+    /**
+     * @brief Ends the current phase, if any, and starts timing another
+     * @param phase The phase
+     */
+    void startPhase(Phase phase);
+
+    /**
+     * @brief Ends the current phase, the time until the next one is only counted in the total
+     */
+    void endPhase();
+
+    void setIterations(int iterations);
+    void setSuccess(bool success);
+
+  protected:
+    typedef std::chrono::steady_clock Clock;
+
+    PlanningStatisticsPtr statistics_;
+    std::string group_;
+    std::string profile_;
+    Sample sample_;
+    int phase_;                           /**< @brief The phase being timed, -1 if none */
+    Clock::time_point start_time_;
+    Clock::time_point phase_start_time_;
+  };
+
+  /**
+   * @brief Constructor
+   * @param latency_objective     The total seconds within which the requests should be solved, zero if none
+   * @param objective_percentile  The fraction of the requests that should meet the objective
+   */
+  explicit PlanningStatistics(double latency_objective = 0.0, double objective_percentile = 0.99);
+
+  /**
+   * @brief Getter for the name of a phase
+   * @param phase The phase
+   * @return The name
+   */
+  static const char* getPhaseName(Phase phase);
+
+  /**
+   * @brief Adds the measurements of a request
+   * @param group   The planning group
+   * @param profile The planning profile
+   * @param sample  The measurements
+   */
+  void record(const std::string& group, const std::string& profile, const Sample& sample);
+
+  /**
+   * @brief Summarizes the statistics of each group and profile in a diagnostic status, which is a warning when the
+   * latency objective is missed by more than the target percentile allows
+   * @param msg The diagnostics, one status per group and profile
+   */
+  void getDiagnostics(diagnostic_msgs::DiagnosticArray& msg) const;
+
+  /**
+   * @brief Writes the summary of each group and profile to a yaml file. The file is replaced atomically so that readers
+   * never see a partial file.
+   * @param filename The file
+   * @return True if succeeded, otherwise false.
+   */
+  bool save(const std::string& filename) const;
+
+protected:
+
+  /** @brief The statistics of a group and profile */
+  struct Entry
+  {
+    std::array<Histogram,NUM_PHASES> latencies;
+    Histogram iterations;
+    std::size_t num_requests = 0;
+    std::size_t num_successes = 0;
+    std::size_t num_within_objective = 0;     /**< @brief The successful requests that met the latency objective */
+  };
+
+  double latency_objective_;
+  double objective_percentile_;
+
+  mutable std::mutex mutex_;
+  std::map<std::pair<std::string,std::string>, Entry> entries_;   /**< @brief The statistics of each [group, profile] */
+};
+
+} /* namespace stomp_moveit */
+
+#endif /* STOMP_MOVEIT_PLANNING_STATISTICS_H_ */
@@ -0,0 +1,207 @@
+/**
+ * @file rollout_worker_pool.h
+ * @brief This defines a pool of worker processes that evaluate the costs of the noisy rollouts
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STOMP_MOVEIT_ROLLOUT_WORKER_POOL_H_
+#define STOMP_MOVEIT_ROLLOUT_WORKER_POOL_H_
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit_msgs/MotionPlanRequest.h>
+#include <stomp_core/utils.h>
+#include <XmlRpcValue.h>
+#include <Eigen/Core>
+#include <semaphore.h>
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace stomp_moveit
+{
+
+class RolloutWorkerPool;
+typedef std::shared_ptr<RolloutWorkerPool> RolloutWorkerPoolPtr;
+
+/**
+ * @brief The start of the shared memory of a RolloutWorkerPool. The rest of the memory holds, at the offsets given
+ * here, the task configuration as xml, the serialized planning scene, the serialized motion plan request and the job
+ * slots. Each slot is a RolloutJob followed by the column major parameters [num_dimensions][num_parameters] and the
+ * state costs [num_timesteps] as doubles.
+ */
+struct RolloutWorkerHeader
+{
+  sem_t jobs_posted;                      /**< @brief Posted once per job of a batch, a worker takes a job per wait */
+  sem_t batch_done;                       /**< @brief Posted by the worker that completes the last job of a batch */
+  std::atomic<uint32_t> num_ready;        /**< @brief The number of workers that loaded their plugins */
+  std::atomic<uint32_t> next_job;         /**< @brief The index of the next job taken by a worker */
+  std::atomic<uint32_t> num_done;         /**< @brief The number of completed jobs of the batch */
+  std::atomic<uint32_t> num_failed;       /**< @brief The number of jobs of the batch whose costs could not be computed */
+
+  uint64_t config_offset;
+  uint64_t config_size;
+  uint64_t scene_version;                 /**< @brief Identifies the contents of the planning scene, 0 if none */
+  uint64_t scene_offset;
+  uint64_t scene_size;
+  uint64_t request_version;               /**< @brief Incremented for each motion plan request, 0 if none */
+  uint64_t request_offset;
+  uint64_t request_size;
+  stomp_core::StompConfiguration stomp_config;  /**< @brief The configuration of the request */
+
+  uint64_t jobs_offset;
+  uint64_t job_size;                      /**< @brief The size of a job slot in bytes */
+  uint32_t num_jobs;
+  uint32_t num_dimensions;
+  uint32_t num_parameters;
+  uint32_t num_timesteps;
+  uint64_t start_timestep;
+  int32_t iteration_number;
+};
+
+/** @brief The start of a job slot */
+struct RolloutJob
+{
+  int32_t rollout_number;
+  uint8_t valid;                          /**< @brief Whether the rollout is valid, set by the worker */
+  uint8_t reserved[3];
+};
+
+/**
+ * @class stomp_moveit::RolloutWorkerPool
+ * @brief Evaluates the costs of the noisy rollouts of a task in separate worker processes that exchange the rollouts
+ * through shared memory. Each worker runs the stomp_rollout_worker executable with its own cost function and noise
+ * generator plugins and a replica of the planning scene, which is only sent again when its contents change. Plugins
+ * that are not thread-safe can then be evaluated concurrently and a crashing plugin does not take down the planner.
+ *
+ * A batch fails if a worker exits or the batch takes longer than the timeout, in that case the workers are
+ * restarted and isReady() returns false until they have loaded their plugins again.
+ *
+ * The pool is shared by the tasks of all the planning contexts of a group. Their batches are evaluated one at a time
+ * and the request of a batch is sent to the workers again when another task used them in between.
+ */
+class RolloutWorkerPool
+{
+public:
+
+  /** @brief A motion plan request passed to the workers by one of the tasks sharing the pool */
+  struct Request
+  {
+    planning_scene::PlanningSceneConstPtr planning_scene;
+    uint64_t scene_version;                 /**< @brief Identifies the contents of the planning scene */
+    moveit_msgs::MotionPlanRequest req;
+    stomp_core::StompConfiguration config;
+  };
+  typedef std::shared_ptr<const Request> RequestConstPtr;
+
+  /**
+   * @brief Constructor, starts the workers
+   * @param group       The planning group
+   * @param task_config The 'task' parameter of the group
+   * @param config      The 'rollout_workers' parameter of the group containing 'num_workers' and optionally
+   *                    'shared_memory_size', 'timeout', 'robot_description' and 'executable'
+   * @throws std::logic_error if the parameters are invalid or the shared memory could not be created
+   */
+  RolloutWorkerPool(const std::string& group, const XmlRpc::XmlRpcValue& task_config, const XmlRpc::XmlRpcValue& config);
+
+  /**
+   * @brief Destructor, stops the workers and removes the shared memory
+   */
+  ~RolloutWorkerPool();
+
+  /**
+   * @brief Whether all the workers are running and have loaded their plugins
+   * @return True if batches can be evaluated, otherwise false.
+   */
+  bool isReady();
+
+  /**
+   * @brief Passes the planning scene and the motion plan request to the workers
+   * @param planning_scene  The planning scene
+   * @param req             The motion plan request
+   * @param config          The Stomp configuration
+   * @return The request to evaluate the batches of, null if it does not fit into the shared memory.
+   */
+  RequestConstPtr setMotionPlanRequest(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                       const moveit_msgs::MotionPlanRequest &req,
+                                       const stomp_core::StompConfiguration &config);
+
+  /**
+   * @brief Evaluates a batch of rollouts in the workers and waits for their costs, see
+   * stomp_core::Task::computeNoisyCostsBatch
+   * @param request The request returned by setMotionPlanRequest()
+   * @return True if all the costs were computed, otherwise false.
+   */
+  bool computeNoisyCosts(const RequestConstPtr& request,
+                         const std::vector<Eigen::MatrixXd>& parameters,
+                         std::size_t start_timestep,
+                         std::size_t num_timesteps,
+                         int iteration_number,
+                         std::vector<Eigen::VectorXd>& costs,
+                         bool& validity);
+
+protected:
+
+  /**
+   * @brief Writes the planning scene, when its contents changed, and the motion plan request into the shared memory
+   * @param request The request
+   * @return True if succeeded, false if they do not fit into the shared memory.
+   */
+  bool writeRequest(const Request& request);
+
+  /**
+   * @brief Starts the worker processes
+   * @return True if all the workers were started, otherwise false.
+   */
+  bool startWorkers();
+
+  /**
+   * @brief Kills the worker processes and resets the synchronization of the shared memory
+   */
+  void stopWorkers();
+
+  /**
+   * @brief Checks that none of the workers exited
+   * @return True if all the workers are running, otherwise false.
+   */
+  bool workersRunning();
+
+protected:
+
+  std::string group_;
+  std::size_t num_workers_;
+  std::size_t shared_memory_size_;
+  double timeout_;                              /**< @brief The seconds a batch may take */
+  std::string robot_description_;
+  std::string executable_;
+
+  std::string shared_memory_name_;
+  void* shared_memory_;
+  RolloutWorkerHeader* header_;
+  std::vector<pid_t> workers_;
+
+  std::mutex mutex_;                            /**< @brief Serializes the tasks sharing the workers */
+  std::weak_ptr<const Request> current_request_; /**< @brief The request in the shared memory */
+};
+
+} /* namespace stomp_moveit */
+
+#endif /* STOMP_MOVEIT_ROLLOUT_WORKER_POOL_H_ */
@@ -0,0 +1,578 @@
+/**
+ * @file static_optimization_task.h
+ * @brief This defines an optimization task whose plugins are a fixed set of classes linked into the planner
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INDUSTRIAL_MOVEIT_STOMP_MOVEIT_INCLUDE_STOMP_MOVEIT_STATIC_OPTIMIZATION_TASK_H_
+#define INDUSTRIAL_MOVEIT_STOMP_MOVEIT_INCLUDE_STOMP_MOVEIT_STATIC_OPTIMIZATION_TASK_H_
+
+#include <stomp_moveit/stomp_optimization_task.h>
+#include <stomp_core/trace.h>
+#include <ros/console.h>
+#include <stdexcept>
+
+namespace stomp_moveit
+{
+
+/**
+ * @brief A compile time list of plugin classes
+ */
+template <typename... Plugins>
+struct PluginList {};
+
+/**
+ * @brief Provides the name of a plugin class as declared in the plugin description files, it must be specialized for
+ * every class of a static pipeline with a function 'static const char* value()'.
+ */
+template <typename Plugin>
+struct PluginName;
+
+/**
+ * @namespace stomp_moveit::static_pipeline
+ * @brief Helpers that call the plugins of a static pipeline through their concrete classes
+ */
+namespace static_pipeline
+{
+
+/** @brief A plugin created by a static pipeline */
+template <typename Base>
+struct StaticPlugin
+{
+  int type;       /**< @brief The index of the plugin class in its list */
+  Base* plugin;   /**< @brief The plugin, owned by the task */
+};
+
+/**
+ * @brief Creates plugins from their names and calls them through their concrete class so that the calls are resolved
+ * at compile time rather than through the plugin base class.
+ */
+template <typename... Plugins>
+struct Dispatch;
+
+template <>
+struct Dispatch<>
+{
+  static bool contains(const std::string& name)
+  {
+    return false;
+  }
+
+  template <typename Base>
+  static int create(const std::string& name, std::shared_ptr<Base>& plugin)
+  {
+    return -1;
+  }
+
+  template <typename Base, typename Function>
+  static bool apply(int type, Base& plugin, Function& function)
+  {
+    return false;
+  }
+};
+
+template <typename Plugin, typename... Plugins>
+struct Dispatch<Plugin, Plugins...>
+{
+  /**
+   * @brief Checks whether a plugin class is in the list
+   * @param name  The plugin name
+   * @return True if found, otherwise false.
+   */
+  static bool contains(const std::string& name)
+  {
+    return name == PluginName<Plugin>::value() || Dispatch<Plugins...>::contains(name);
+  }
+
+  /**
+   * @brief Creates a plugin
+   * @param name    The plugin name
+   * @param plugin  The created plugin
+   * @return The index of the plugin class in the list, -1 if not found.
+   */
+  template <typename Base>
+  static int create(const std::string& name, std::shared_ptr<Base>& plugin)
+  {
+    if(name == PluginName<Plugin>::value())
+    {
+      plugin = std::make_shared<Plugin>();
+      return 0;
+    }
+
+    int type = Dispatch<Plugins...>::create(name,plugin);
+    return type < 0 ? type : type + 1;
+  }
+
+  /**
+   * @brief Calls a function with the plugin cast to its class
+   * @param type      The index of the plugin class in the list
+   * @param plugin    The plugin
+   * @param function  The function, called with the plugin
+   * @return The function result.
+   */
+  template <typename Base, typename Function>
+  static bool apply(int type, Base& plugin, Function& function)
+  {
+    return type == 0 ? function(static_cast<Plugin&>(plugin)) : Dispatch<Plugins...>::apply(type - 1,plugin,function);
+  }
+};
+
+/** @brief Calls the generateNoise() method of a noise generator */
+struct GenerateNoise
+{
+  const Eigen::MatrixXd& parameters;
+  std::size_t start_timestep;
+  std::size_t num_timesteps;
+  int iteration_number;
+  int rollout_number;
+  Eigen::MatrixXd& parameters_noise;
+  Eigen::MatrixXd& noise;
+
+  template <typename Plugin>
+  bool operator()(Plugin& p)
+  {
+    stomp_core::TraceSpan span(PluginName<Plugin>::value(),"generateNoise","rollout",rollout_number);
+    return p.Plugin::generateNoise(parameters,start_timestep,num_timesteps,iteration_number,rollout_number,
+                                   parameters_noise,noise);
+  }
+};
+
+/** @brief Calls the computeCosts() method of a cost function and gets its weight */
+struct ComputeCosts
+{
+  const Eigen::MatrixXd& parameters;
+  std::size_t start_timestep;
+  std::size_t num_timesteps;
+  int iteration_number;
+  int rollout_number;       /**< @brief The rollout, ignored when evaluating the optimized parameters */
+  bool optimized;           /**< @brief Whether the parameters are the optimized ones */
+  Eigen::VectorXd& costs;
+  bool& validity;
+  double& weight;
+
+  template <typename Plugin>
+  bool operator()(Plugin& p)
+  {
+    stomp_core::TraceSpan span(PluginName<Plugin>::value(),"computeCosts",optimized ? nullptr : "rollout",
+                               rollout_number);
+    weight = p.Plugin::getWeight();
+    return p.Plugin::computeCosts(parameters,start_timestep,num_timesteps,iteration_number,
+                                  optimized ? p.Plugin::getOptimizedIndex() : rollout_number,costs,validity);
+  }
+};
+
+/** @brief Calls the filter() method of a noisy filter */
+struct FilterNoisyParameters
+{
+  std::size_t start_timestep;
+  std::size_t num_timesteps;
+  int iteration_number;
+  int rollout_number;
+  Eigen::MatrixXd& parameters;
+  bool& filtered;
+
+  template <typename Plugin>
+  bool operator()(Plugin& p)
+  {
+    stomp_core::TraceSpan span(PluginName<Plugin>::value(),"filterNoisyParameters","rollout",rollout_number);
+    return p.Plugin::filter(start_timestep,num_timesteps,iteration_number,rollout_number,parameters,filtered);
+  }
+};
+
+/** @brief Calls the filter() method of an update filter */
+struct FilterParameterUpdates
+{
+  std::size_t start_timestep;
+  std::size_t num_timesteps;
+  int iteration_number;
+  const Eigen::MatrixXd& parameters;
+  Eigen::MatrixXd& updates;
+  bool& filtered;
+
+  template <typename Plugin>
+  bool operator()(Plugin& p)
+  {
+    stomp_core::TraceSpan span(PluginName<Plugin>::value(),"filterParameterUpdates");
+    return p.Plugin::filter(start_timestep,num_timesteps,iteration_number,parameters,updates,filtered);
+  }
+};
+
+} // end of namespace static_pipeline
+
+template <typename CostFunctions, typename NoiseGenerators, typename NoisyFilters, typename UpdateFilters>
+class StaticOptimizationTask;
+
+/**
+ * @class stomp_moveit::StaticOptimizationTask
+ * @brief An optimization task that creates its plugins from compile time lists of classes instead of loading them with
+ * pluginlib. The per rollout calls into the plugins are made through their concrete classes, which lets the compiler
+ * resolve and inline them.
+ *
+ * The plugins and their parameters are still read from the task configuration, each listed class must be in one of the
+ * lists. Otherwise the task falls back to loading all its plugins with pluginlib.
+ */
+template <typename... CostFunctions, typename... NoiseGenerators, typename... NoisyFilters, typename... UpdateFilters>
+class StaticOptimizationTask<PluginList<CostFunctions...>, PluginList<NoiseGenerators...>,
+                             PluginList<NoisyFilters...>, PluginList<UpdateFilters...> >: public StompOptimizationTask
+{
+public:
+
+  typedef static_pipeline::Dispatch<CostFunctions...> CostFunctionDispatch;
+  typedef static_pipeline::Dispatch<NoiseGenerators...> NoiseGeneratorDispatch;
+  typedef static_pipeline::Dispatch<NoisyFilters...> NoisyFilterDispatch;
+  typedef static_pipeline::Dispatch<UpdateFilters...> UpdateFilterDispatch;
+
+  /**
+   * @brief Constructor
+   * @param robot_model_ptr     A pointer to the robot model
+   * @param group_name          The planning group name
+   * @param config              The configuration parameter data
+   * @param lazy_plugin_loading Whether the plugins are created by the first setMotionPlanRequest() call instead of
+   *                            the constructor
+   */
+  StaticOptimizationTask(moveit::core::RobotModelConstPtr robot_model_ptr, std::string group_name,
+                         const XmlRpc::XmlRpcValue& config, bool lazy_plugin_loading = false):
+    StompOptimizationTask(robot_model_ptr,group_name,config,true),
+    static_(false)
+  {
+    if(!lazy_plugin_loading && !loadPlugins())
+    {
+      throw std::logic_error("plugin not found");
+    }
+  }
+
+  virtual ~StaticOptimizationTask()
+  {
+
+  }
+
+  /**
+   * @brief Creates the plugins from the class lists, or loads them with pluginlib when the configuration lists other
+   * classes.
+   * @return  true if the required plugins were created, false otherwise.
+   */
+  virtual bool loadPlugins() override
+  {
+    if(plugins_loaded_)
+    {
+      return true;
+    }
+
+    if(!hasStaticPlugins<CostFunctionDispatch>("cost_functions") ||
+       !hasStaticPlugins<NoiseGeneratorDispatch>("noise_generator") ||
+       !hasStaticPlugins<NoisyFilterDispatch>("noisy_filters") ||
+       !hasStaticPlugins<UpdateFilterDispatch>("update_filters"))
+    {
+      ROS_WARN("StompOptimizationTask/%s lists plugins outside of the static pipeline, loading them with pluginlib",
+               group_name_.c_str());
+      return StompOptimizationTask::loadPlugins();
+    }
+
+    if(!createPlugins<CostFunctionDispatch>("cost_functions","CostFunction",true,false,
+                                            cost_functions_,static_cost_functions_))
+    {
+      ROS_ERROR("StompOptimizationTask/%s failed to create 'cost_functions' plugins",group_name_.c_str());
+      return false;
+    }
+
+    if(!createPlugins<NoiseGeneratorDispatch>("noise_generator","NoiseGenerator",true,true,
+                                              noise_generators_,static_noise_generators_))
+    {
+      ROS_ERROR("StompOptimizationTask/%s failed to create 'noise_generator' plugins",group_name_.c_str());
+      return false;
+    }
+
+    if(!createPlugins<NoisyFilterDispatch>("noisy_filters","NoisyFilter",false,false,
+                                           noisy_filters_,static_noisy_filters_))
+    {
+      ROS_WARN("StompOptimizationTask/%s failed to create 'noisy_filters' plugins",group_name_.c_str());
+    }
+
+    if(!createPlugins<UpdateFilterDispatch>("update_filters","UpdateFilter",false,false,
+                                            update_filters_,static_update_filters_))
+    {
+      ROS_WARN("StompOptimizationTask/%s failed to create 'update_filters' plugins",group_name_.c_str());
+    }
+
+    static_ = true;
+    plugins_loaded_ = true;
+    return true;
+  }
+
+  virtual bool generateNoisyParameters(const Eigen::MatrixXd& parameters,
+                                       std::size_t start_timestep,
+                                       std::size_t num_timesteps,
+                                       int iteration_number,
+                                       int rollout_number,
+                                       Eigen::MatrixXd& parameters_noise,
+                                       Eigen::MatrixXd& noise) override
+  {
+    if(!static_)
+    {
+      return StompOptimizationTask::generateNoisyParameters(parameters,start_timestep,num_timesteps,iteration_number,
+                                                            rollout_number,parameters_noise,noise);
+    }
+
+    static_pipeline::GenerateNoise generate = {parameters,start_timestep,num_timesteps,iteration_number,rollout_number,
+                                               parameters_noise,noise};
+    const auto& g = static_noise_generators_.back();
+    return NoiseGeneratorDispatch::apply(g.type,*g.plugin,generate);
+  }
+
+  virtual bool computeNoisyCosts(const Eigen::MatrixXd& parameters,
+                                 std::size_t start_timestep,
+                                 std::size_t num_timesteps,
+                                 int iteration_number,
+                                 int rollout_number,
+                                 Eigen::VectorXd& costs,
+                                 bool& validity) override
+  {
+    if(!static_)
+    {
+      return StompOptimizationTask::computeNoisyCosts(parameters,start_timestep,num_timesteps,iteration_number,
+                                                      rollout_number,costs,validity);
+    }
+
+    return computeStaticCosts(parameters,start_timestep,num_timesteps,iteration_number,rollout_number,false,
+                              costs,validity);
+  }
+
+  virtual bool computeCosts(const Eigen::MatrixXd& parameters,
+                            std::size_t start_timestep,
+                            std::size_t num_timesteps,
+                            int iteration_number,
+                            Eigen::VectorXd& costs,
+                            bool& validity) override
+  {
+    if(!static_)
+    {
+      return StompOptimizationTask::computeCosts(parameters,start_timestep,num_timesteps,iteration_number,
+                                                 costs,validity);
+    }
+
+    if(!computeStaticCosts(parameters,start_timestep,num_timesteps,iteration_number,0,true,costs,validity))
+    {
+      return false;
+    }
+    setOptimizedCosts(parameters,iteration_number,costs,validity);
+    return true;
+  }
+
+  virtual bool filterNoisyParameters(std::size_t start_timestep,
+                                     std::size_t num_timesteps,
+                                     int iteration_number,
+                                     int rollout_number,
+                                     Eigen::MatrixXd& parameters,
+                                     bool& filtered) override
+  {
+    if(!static_)
+    {
+      return StompOptimizationTask::filterNoisyParameters(start_timestep,num_timesteps,iteration_number,rollout_number,
+                                                          parameters,filtered);
+    }
+
+    filtered = false;
+    bool temp;
+    static_pipeline::FilterNoisyParameters filter = {start_timestep,num_timesteps,iteration_number,rollout_number,
+                                                     parameters,temp};
+    for(const auto& f : static_noisy_filters_)
+    {
+      if(!NoisyFilterDispatch::apply(f.type,*f.plugin,filter))
+      {
+        return false;
+      }
+      filtered |= temp;
+    }
+    return true;
+  }
+
+  virtual bool filterParameterUpdates(std::size_t start_timestep,
+                                      std::size_t num_timesteps,
+                                      int iteration_number,
+                                      const Eigen::MatrixXd& parameters,
+                                      Eigen::MatrixXd& updates) override
+  {
+    if(!static_)
+    {
+      return StompOptimizationTask::filterParameterUpdates(start_timestep,num_timesteps,iteration_number,parameters,
+                                                           updates);
+    }
+
+    bool temp;
+    static_pipeline::FilterParameterUpdates filter = {start_timestep,num_timesteps,iteration_number,parameters,
+                                                      updates,temp};
+    for(const auto& f : static_update_filters_)
+    {
+      if(!UpdateFilterDispatch::apply(f.type,*f.plugin,filter))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+protected:
+
+  /**
+   * @brief Checks whether all the plugins of a configuration entry are in a class list
+   * @param param_key The configuration entry
+   * @return True if all the classes are in the list or the entry is missing, otherwise false.
+   */
+  template <typename Dispatch>
+  bool hasStaticPlugins(const std::string& param_key)
+  {
+    if(!config_.hasMember(param_key) || config_[param_key].getType() != XmlRpc::XmlRpcValue::TypeArray)
+    {
+      return true;
+    }
+
+    XmlRpc::XmlRpcValue& plugin_list = config_[param_key];
+    for(auto i = 0; i < plugin_list.size(); i++)
+    {
+      XmlRpc::XmlRpcValue& plugin_config = plugin_list[i];
+      if(plugin_config.hasMember("class") && plugin_config["class"].getType() == XmlRpc::XmlRpcValue::TypeString &&
+         !Dispatch::contains(static_cast<std::string>(plugin_config["class"])))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Creates and initializes the plugins of a configuration entry in the listed order
+   * @param param_key       The configuration entry
+   * @param plugin_desc     A brief description of the plugin
+   * @param critical        Whether a plugin that fails to initialize is an error
+   * @param single_instance Whether only one plugin is expected
+   * @param plugins         The created plugins
+   * @param static_plugins  The created plugins along with their class index
+   * @return True if succeeded, otherwise false.
+   */
+  template <typename Dispatch, typename Base>
+  bool createPlugins(const std::string& param_key, const std::string& plugin_desc, bool critical, bool single_instance,
+                     std::vector< std::shared_ptr<Base> >& plugins,
+                     std::vector< static_pipeline::StaticPlugin<Base> >& static_plugins)
+  {
+    if(!config_.hasMember(param_key) || config_[param_key].getType() != XmlRpc::XmlRpcValue::TypeArray)
+    {
+      ROS_WARN("Plugin under entry '%s' was not found in ros parameter.",param_key.c_str());
+      return false;
+    }
+
+    XmlRpc::XmlRpcValue& plugin_list = config_[param_key];
+    for(auto i = 0; i < plugin_list.size(); i++)
+    {
+      XmlRpc::XmlRpcValue& plugin_config = plugin_list[i];
+      if(!plugin_config.hasMember("class") || plugin_config["class"].getType() != XmlRpc::XmlRpcValue::TypeString)
+      {
+        ROS_ERROR("Element in the '%s' array parameter did not contain a 'class' entry",param_key.c_str());
+        return false;
+      }
+
+      std::string class_name = static_cast<std::string>(plugin_config["class"]);
+      std::shared_ptr<Base> plugin;
+      int type = Dispatch::create(class_name,plugin);
+      if(!plugin->initialize(robot_model_ptr_,group_name_,plugin_config))
+      {
+        if(critical)
+        {
+          ROS_ERROR("%s plugin '%s' failed to initialize",plugin_desc.c_str(),class_name.c_str());
+          return false;
+        }
+
+        ROS_WARN("%s plugin '%s' failed to initialize",plugin_desc.c_str(),class_name.c_str());
+        continue;
+      }
+
+      plugins.push_back(plugin);
+      static_plugins.push_back({type,plugin.get()});
+      ROS_INFO_STREAM("Stomp Optimization Task created static "<< plugin_desc <<" '"<<plugin->getName()<<"' plugin");
+
+      if(single_instance)
+      {
+        break;
+      }
+    }
+
+    return !plugins.empty();
+  }
+
+  /**
+   * @brief Adds up the weighted costs of the cost functions
+   * @param parameters        The parameters to evaluate
+   * @param start_timestep    The start index into the 'parameters' array, usually 0.
+   * @param num_timesteps     The number of elements to use from 'parameters' starting from 'start_timestep'
+   * @param iteration_number  The current iteration count in the optimization loop
+   * @param rollout_number    The index of the noisy trajectory
+   * @param optimized         Whether the parameters are the optimized ones
+   * @param costs             The state costs per timestep
+   * @param validity          Whether the parameters are valid according to all the cost functions
+   * @return  false if there was an irrecoverable failure, true otherwise.
+   */
+  bool computeStaticCosts(const Eigen::MatrixXd& parameters, std::size_t start_timestep, std::size_t num_timesteps,
+                          int iteration_number, int rollout_number, bool optimized, Eigen::VectorXd& costs,
+                          bool& validity)
+  {
+    Eigen::VectorXd state_costs = Eigen::VectorXd::Zero(num_timesteps);
+    bool valid;
+    double weight;
+    static_pipeline::ComputeCosts compute = {parameters,start_timestep,num_timesteps,iteration_number,rollout_number,
+                                             optimized,state_costs,valid,weight};
+
+    costs = Eigen::VectorXd::Zero(num_timesteps);
+    validity = true;
+    for(const auto& cf : static_cost_functions_)
+    {
+      if(!CostFunctionDispatch::apply(cf.type,*cf.plugin,compute))
+      {
+        return false;
+      }
+
+      validity &= valid;
+      costs += state_costs * weight;
+    }
+    return true;
+  }
+
+protected:
+
+  bool static_;         /**< @brief Whether the plugins were created from the class lists */
+
+  /**< The created plugins along with their class index, owned by the arrays of the base class >*/
+  std::vector< static_pipeline::StaticPlugin<cost_functions::StompCostFunction> > static_cost_functions_;
+  std::vector< static_pipeline::StaticPlugin<noise_generators::StompNoiseGenerator> > static_noise_generators_;
+  std::vector< static_pipeline::StaticPlugin<noisy_filters::StompNoisyFilter> > static_noisy_filters_;
+  std::vector< static_pipeline::StaticPlugin<update_filters::StompUpdateFilter> > static_update_filters_;
+};
+
+/**
+ * @brief Creates a task with the static pipeline of the plugins built into stomp_moveit
+ * @param robot_model_ptr     A pointer to the robot model
+ * @param group_name          The planning group name
+ * @param config              The configuration parameter data
+ * @param lazy_plugin_loading Whether the plugins are created by the first motion plan request
+ * @return The task
+ */
+std::shared_ptr<StompOptimizationTask> createBuiltinOptimizationTask(moveit::core::RobotModelConstPtr robot_model_ptr,
+                                                                     std::string group_name,
+                                                                     const XmlRpc::XmlRpcValue& config,
+                                                                     bool lazy_plugin_loading);
+
+} /* namespace stomp_moveit */
+
+#endif /* INDUSTRIAL_MOVEIT_STOMP_MOVEIT_INCLUDE_STOMP_MOVEIT_STATIC_OPTIMIZATION_TASK_H_ */
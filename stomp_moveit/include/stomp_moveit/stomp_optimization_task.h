@@ -26,6 +26,7 @@
 #ifndef INDUSTRIAL_MOVEIT_STOMP_MOVEIT_INCLUDE_STOMP_MOVEIT_STOMP_OPTIMIZATION_TASK_H_
 #define INDUSTRIAL_MOVEIT_STOMP_MOVEIT_INCLUDE_STOMP_MOVEIT_STOMP_OPTIMIZATION_TASK_H_
 
+#include <functional>
 #include <memory>
 #include <moveit_msgs/MotionPlanRequest.h>
 #include <moveit/robot_model/robot_model.h>
@@ -36,6 +37,7 @@
 #include <stomp_moveit/noise_generators/stomp_noise_generator.h>
 #include <stomp_moveit/noisy_filters/stomp_noisy_filter.h>
 #include <stomp_moveit/update_filters/stomp_update_filter.h>
+#include <stomp_moveit/rollout_worker_pool.h>
 
 
 namespace stomp_moveit
@@ -62,16 +64,34 @@ typedef std::shared_ptr<NoiseGeneratorLoader> NoiseGeneratorLoaderPtr;
 class StompOptimizationTask: public stomp_core::Task
 {
 public:
+
+  /**
+   * @brief Receives each valid trajectory that lowers the cost during the optimization
+   * @param iteration   The iteration that found the trajectory
+   * @param cost        The sum of the state costs of the trajectory
+   * @param parameters  The trajectory [num_dimensions x num_timesteps]
+   */
+  typedef std::function<void (int iteration,double cost,const Eigen::MatrixXd& parameters)> ImprovementCallback;
+
   /**
    * @brief Constructor
-   * @param robot_model_ptr A pointer to the robot model
-   * @param group_name      The planning group name
-   * @param config          The configuration parameter data
+   * @param robot_model_ptr     A pointer to the robot model
+   * @param group_name          The planning group name
+   * @param config              The configuration parameter data
+   * @param lazy_plugin_loading Whether the plugins are loaded by the first setMotionPlanRequest() call instead of
+   *                            the constructor
    */
   StompOptimizationTask(moveit::core::RobotModelConstPtr robot_model_ptr, std::string group_name,
-                        const XmlRpc::XmlRpcValue& config);
+                        const XmlRpc::XmlRpcValue& config, bool lazy_plugin_loading = false);
   virtual ~StompOptimizationTask();
 
+  /**
+   * @brief Creates and initializes the plugins from the configuration unless already done. The plugin class loaders are
+   * shared by all the tasks in the process.
+   * @return  true if the required plugins were loaded, false otherwise.
+   */
+  virtual bool loadPlugins();
+
   /**
    * @brief Passes the planning details down to each loaded plugin
    * @param planning_scene  A smart pointer to the planning scene
@@ -123,6 +143,30 @@ public:
                        Eigen::VectorXd& costs,
                        bool& validity) override;
 
+  /**
+   * @brief Whether the noisy rollouts are evaluated in batches, which is the case when rollout workers are set
+   * @return True if rollout workers are set, otherwise false.
+   */
+  virtual bool supportsNoisyCostsBatch() const override;
+
+  /**
+   * @brief computes the state costs of all the noisy rollouts of an iteration in the rollout workers. The planner
+   * evaluates them itself while the workers are not ready or when the request could not be passed to them.
+   * @param parameters        The [num_dimensions] x [num_parameters] policy parameters of each rollout
+   * @param start_timestep    start index into the 'parameters' arrays, usually 0.
+   * @param num_timesteps     number of elements to use from 'parameters' starting from 'start_timestep'
+   * @param iteration_number  The current iteration count in the optimization loop
+   * @param costs             vectors containing the state costs per timestep of each rollout.
+   * @param validity          whether or not all the trajectories are valid
+   * @return  false if there was an irrecoverable failure, true otherwise.
+   */
+  virtual bool computeNoisyCostsBatch(const std::vector<Eigen::MatrixXd>& parameters,
+                                      std::size_t start_timestep,
+                                      std::size_t num_timesteps,
+                                      int iteration_number,
+                                      std::vector<Eigen::VectorXd>& costs,
+                                      bool& validity) override;
+
   /**
    * @brief computes the state costs as a function of the optimized parameters for each time step. It does this by calling the loaded Cost Function plugins
    * @param parameters        [num_dimensions] num_parameters - policy parameters to execute
@@ -197,14 +241,58 @@ public:
    */
   virtual void done(bool success,int total_iterations,double final_cost,const Eigen::MatrixXd& parameters) override;
 
+  /**
+   * @brief Sets the function called from postIteration() whenever the optimized parameters evaluated in that iteration
+   * are valid and have the lowest cost so far in the current motion plan request. Iterations that failed before the
+   * evaluation are skipped. It runs on the optimization thread.
+   * @param callback  The callback, an empty function disables it
+   */
+  void setImprovementCallback(ImprovementCallback callback);
+
+  /**
+   * @brief Sets the worker processes that evaluate the noisy rollouts, which may be shared with other tasks
+   * @param workers The workers, null to evaluate the rollouts in the planner
+   */
+  void setRolloutWorkers(RolloutWorkerPoolPtr workers);
+
+  /**
+   * @brief Collects the validity certificates of the cost functions for the last optimization
+   * @param certificates  The trajectories found collision free
+   */
+  void getValidityCertificates(std::vector<cost_functions::ValidityCertificate>& certificates) const;
+
+  /**
+   * @brief Getter for the cost of the last optimization
+   * @return The final cost passed to done()
+   */
+  double getFinalCost() const;
+
+  /**
+   * @brief Getter for the iterations of the last optimization
+   * @return The total iterations passed to done()
+   */
+  int getFinalIterations() const;
+
 protected:
 
+  /**
+   * @brief Records the evaluation of the optimized parameters that postIteration() reports to the improvement callback
+   * @param parameters        The optimized parameters [num_dimensions x num_timesteps]
+   * @param iteration_number  The current iteration count in the optimization loop
+   * @param costs             The state costs of the parameters
+   * @param validity          Whether the parameters are valid
+   */
+  void setOptimizedCosts(const Eigen::MatrixXd& parameters,int iteration_number,const Eigen::VectorXd& costs,
+                         bool validity);
+
   // robot environment
   std::string group_name_;
   moveit::core::RobotModelConstPtr robot_model_ptr_;
   planning_scene::PlanningSceneConstPtr planning_scene_ptr_;
+  XmlRpc::XmlRpcValue config_;
+  bool plugins_loaded_;
 
-  /**< The plugin loaders for each type of plugin supported>*/
+  /**< The plugin loaders for each type of plugin supported, shared by all the tasks >*/
   CostFuctionLoaderPtr cost_function_loader_;
   NoisyFilterLoaderPtr noisy_filter_loader_;
   UpdateFilterLoaderPtr update_filter_loader_;
@@ -215,6 +303,20 @@ protected:
   std::vector<noisy_filters::StompNoisyFilterPtr> noisy_filters_;
   std::vector<update_filters::StompUpdateFilterPtr> update_filters_;
   std::vector<noise_generators::StompNoiseGeneratorPtr> noise_generators_;
+
+  RolloutWorkerPoolPtr rollout_workers_;
+  RolloutWorkerPool::RequestConstPtr rollout_workers_request_;  /**< @brief The current request passed to the rollout workers, null if none */
+
+  double final_cost_;     /**< @brief The cost of the last optimized parameters */
+  int final_iterations_;  /**< @brief The iterations of the last optimization */
+
+  // improvement notification
+  ImprovementCallback improvement_callback_;
+  Eigen::MatrixXd optimized_parameters_;  /**< @brief The last evaluated optimized parameters */
+  double optimized_cost_;                 /**< @brief The sum of the state costs of the last evaluated optimized parameters */
+  bool optimized_valid_;                  /**< @brief Whether the last evaluated optimized parameters are valid */
+  int optimized_iteration_;               /**< @brief The iteration the optimized parameters were evaluated in, -1 if none */
+  double lowest_valid_cost_;              /**< @brief The lowest cost of valid optimized parameters in the current request */
 };
 
 
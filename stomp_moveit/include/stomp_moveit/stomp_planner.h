@@ -28,9 +28,14 @@
 
 #include <moveit/planning_interface/planning_interface.h>
 #include <stomp_core/stomp.h>
+#include <stomp_moveit/planning_statistics.h>
 #include <stomp_moveit/stomp_optimization_task.h>
 #include <stomp_moveit/utils/kinematics.h>
+#include <stomp_moveit/utils/trajectory_library.h>
+#include <stomp_moveit/utils/triple_buffer.h>
 #include <boost/thread.hpp>
+#include <atomic>
+#include <thread>
 #include <ros/ros.h>
 
 namespace stomp_moveit
@@ -48,6 +53,28 @@ using StompOptimizationTaskPtr = std::shared_ptr<StompOptimizationTask>;
 class StompPlanner: public planning_interface::PlanningContext
 {
 public:
+
+  /** @brief A valid trajectory found while the optimization is still in progress */
+  struct StreamedSolution
+  {
+    unsigned long solve_id = 0;       /**< @brief Identifies the solve() call that found it, starting from 1 */
+    int iteration = 0;                /**< @brief The optimization iteration that found it */
+    double cost = 0.0;                /**< @brief The sum of the state costs of the trajectory */
+    Eigen::MatrixXd parameters;       /**< @brief The joint values [num joints][num_timesteps] of the group active joints */
+  };
+
+  /** @brief Receives each streamed solution on the optimization thread, so it should return quickly */
+  typedef std::function<void (const StreamedSolution&)> SolutionCallback;
+
+  /**
+   * @brief Receives the trajectory improved by the background refinement of a solve() call
+   * @param solve_id    Identifies the solve() call as in StreamedSolution
+   * @param trajectory  The refined trajectory, already validated against the planning scene
+   * @param cost        The refined trajectory cost
+   */
+  typedef std::function<void (unsigned long solve_id, const robot_trajectory::RobotTrajectoryPtr& trajectory,
+                              double cost)> RefinementCallback;
+
   /**
    * @brief StompPlanner constructor.
    * @param group   The planning group for which this instance will plan.
@@ -73,15 +100,25 @@ public:
 
   /**
    * @brief Thread-safe method that request early termination, if a solve() function is currently computing plans.
+   * The termination holds until the next clear(), so it also applies when issued while solve() is setting up.
    * @return true if succeeded, false otherwise.
    */
   virtual bool terminate() override;
 
   /**
-   * @brief Clears results from previous plan.
+   * @brief Clears results from previous plan and stops the background refinement. Must be called before setting a new
+   * planning scene or motion plan request.
    */
   virtual void clear() override;
 
+  /**
+   * @brief Pays the first request costs ahead of time: computes the optimization matrices and noise covariances of the
+   * configured trajectory size and of every adaptive size, runs the IK solver once and solves a synthetic request in an
+   * empty planning scene. The synthetic solution is neither stored in the trajectory library, streamed nor refined.
+   * @return  true if the synthetic request was solved, false otherwise.
+   */
+  bool warmUp();
+
   /**
    * @brief Convenience method to load extract the parameters for each supported planning group.
    * @param nh      A ros node handle.
@@ -106,6 +143,54 @@ public:
    */
   static moveit_msgs::TrajectoryConstraints encodeSeedTrajectory(const trajectory_msgs::JointTrajectory& seed);
 
+  /**
+   * @brief Sets the library of previous trajectories used to seed requests that have no seed of their own.
+   * @param library The trajectory library, may be shared among the planners of the same group. Null disables it.
+   */
+  void setTrajectoryLibrary(utils::TrajectoryLibraryPtr library);
+
+  /**
+   * @brief Getter for the trajectory library
+   * @return The trajectory library, null when the experience based seeding is disabled.
+   */
+  utils::TrajectoryLibraryPtr getTrajectoryLibrary() const;
+
+  /**
+   * @brief Sets the worker processes that evaluate the noisy rollouts of the optimization.
+   * @param workers The rollout workers, may be shared among the planners of the same group. Null evaluates the rollouts
+   * in the planner.
+   */
+  void setRolloutWorkers(RolloutWorkerPoolPtr workers);
+
+  /**
+   * @brief Sets the statistics that the phase durations, iterations and outcome of each solve() call are recorded into.
+   * @param statistics  The statistics, may be shared among planners. Null disables the recording.
+   * @param profile     The planning profile the planner was configured for
+   */
+  void setPlanningStatistics(PlanningStatisticsPtr statistics, const std::string& profile);
+
+  /**
+   * @brief Enables or disables the streaming of every lower cost collision free trajectory found during the optimization,
+   * so that execution can start before solve() returns. The streamed trajectories have not been time parameterized nor
+   * checked against the planning scene by the planner yet.
+   * @param enable    Whether to stream the solutions
+   * @param callback  Optional function that receives each solution
+   */
+  void setSolutionStreaming(bool enable, SolutionCallback callback = SolutionCallback());
+
+  /**
+   * @brief Gets the latest streamed solution without blocking the optimization. Only one thread may call this method.
+   * @param solution  The latest solution
+   * @return True if a solution was streamed since the previous call, otherwise false.
+   */
+  bool getLatestSolution(StreamedSolution& solution);
+
+  /**
+   * @brief Sets the function that receives the trajectories improved by the background refinement.
+   * @param callback  The callback, runs on the refinement thread
+   */
+  void setRefinementCallback(RefinementCallback callback);
+
 protected:
 
   /**
@@ -122,15 +207,91 @@ protected:
   bool getStartAndGoal(Eigen::VectorXd& start, Eigen::VectorXd& goal);
 
   /**
-   * @brief This function 1) gets the seed trajectory from the active motion plan request, 2) checks to see if
-   * the given seed trajectory makes sense in the context of the user provided goal constraints, 3) modifies
-   * the seed's first and last point to 'fix' it for small deviations in the goal constraints and 4) applies
-   * a smoothing method to the seed.
+   * @brief Computes the number of timesteps for a motion between the start and goal so that the trajectory resolution
+   * is proportional to the time it takes the slowest joint to complete its motion at the maximum velocity.
+   * @param start The start joint values
+   * @param goal  The goal joint values
+   * @return The number of timesteps within [min_num_timesteps, max_num_timesteps]; the configured number of
+   * timesteps is returned when the adaptive timesteps are disabled.
+   */
+  int computeNumTimesteps(const Eigen::VectorXd& start, const Eigen::VectorXd& goal) const;
+
+  /**
+   * @brief This function gets the seed trajectory from the active motion plan request and fits it to the request
+   * through fitSeedToRequest().
    * @param parameters  Output argument containing the seed parameters
    * @return True if the seed state is deemed to be valid. False otherwise.
    */
   bool getSeedParameters(Eigen::MatrixXd& parameters) const;
 
+  /**
+   * @brief This function 1) checks to see if the given seed trajectory makes sense in the context of the user provided
+   * goal constraints, 2) modifies the seed's first and last point to 'fix' it for small deviations in the goal
+   * constraints and 3) applies a smoothing method to the seed.
+   * @param parameters  The seed parameters [num joints][num_timesteps], modified in place
+   * @return True if the seed state is deemed to be valid. False otherwise.
+   */
+  bool fitSeedToRequest(Eigen::MatrixXd& parameters) const;
+
+  /**
+   * @brief Looks up the library trajectory nearest to the start and goal of the active motion plan request and fits
+   * it to the request.
+   * @param parameters  Output argument containing the seed parameters
+   * @return True if a suitable trajectory was found, otherwise false.
+   */
+  bool getLibrarySeedParameters(Eigen::MatrixXd& parameters);
+
+  /**
+   * @brief Checks the planned trajectory against the planning scene. The collision check of the waypoints that a cost
+   * function already found collision free in the same planning scene is skipped and the remaining waypoints are
+   * split among 'num_validation_threads' workers, which all stop at the first invalid waypoint.
+   * @param scene       The planning scene the trajectory was planned in.
+   * @param parameters  The optimized parameters [num joints][num_timesteps] that the trajectory was created from.
+   * @param trajectory  The time parameterized trajectory.
+   * @return  true if all the waypoints are valid, false otherwise.
+   */
+  bool isTrajectoryValid(const planning_scene::PlanningSceneConstPtr& scene, const Eigen::MatrixXd& parameters,
+                         const robot_trajectory::RobotTrajectory& trajectory) const;
+
+  /**
+   * @brief Publishes an improved trajectory to the streaming buffer and callback
+   * @param iteration   The iteration that found the trajectory
+   * @param cost        The trajectory cost
+   * @param parameters  The trajectory [num joints][num_timesteps]
+   */
+  void streamSolution(int iteration, double cost, const Eigen::MatrixXd& parameters);
+
+  /**
+   * @brief Keeps optimizing a valid solution on a background thread for at most 'num_iterations' and 'max_time'.
+   * @param parameters  The solution returned by solve() [num joints][num_timesteps]
+   * @param config      The configuration used to find the solution
+   */
+  void startRefinement(const Eigen::MatrixXd& parameters, const stomp_core::StompConfiguration& config);
+
+  /**
+   * @brief The background refinement, publishes the refined trajectory when it lowers the cost and remains valid.
+   * @param parameters    The solution returned by solve()
+   * @param initial_cost  The cost of that solution
+   * @param solve_id      The solve() call that found it
+   * @param scene         The planning scene of that solve() call
+   * @param request       The motion plan request of that solve() call
+   * @param config        The refinement configuration
+   */
+  void refine(Eigen::MatrixXd parameters, double initial_cost, unsigned long solve_id,
+              planning_scene::PlanningSceneConstPtr scene, moveit_msgs::MotionPlanRequest request,
+              stomp_core::StompConfiguration config);
+
+  /**
+   * @brief Cancels the background refinement and waits for it to finish.
+   */
+  void stopRefinement();
+
+  /**
+   * @brief Cancels Stomp again when terminate() was called since the last clear(), must be called after every
+   * Stomp::setConfig() of a solve() since the configuration resets the cancellation.
+   */
+  void cancelIfTerminated();
+
   /**
    * @brief Converts from an Eigen Matrix to to a joint trajectory
    * @param parameters  The input matrix of size [num joints][num_timesteps] containing the trajectory joint values.
@@ -164,6 +325,38 @@ protected:
   XmlRpc::XmlRpcValue config_;
   stomp_core::StompConfiguration stomp_config_;
 
+  // adaptive timesteps
+  bool adaptive_timesteps_;                     /**< @brief Whether the number of timesteps is computed for each request */
+  int min_num_timesteps_;                       /**< @brief The minimum number of timesteps of an adaptive trajectory */
+  int max_num_timesteps_;                       /**< @brief The maximum number of timesteps of an adaptive trajectory */
+  double seconds_per_timestep_;                 /**< @brief The motion duration covered by each timestep of an adaptive trajectory */
+
+  // experience based seeding
+  utils::TrajectoryLibraryPtr trajectory_library_;
+  double library_max_distance_;                 /**< @brief The largest [start, goal] distance of a library seed */
+
+  // trajectory validation
+  int num_validation_threads_;                  /**< @brief The number of threads checking the final trajectory */
+
+  // solution streaming
+  bool stream_solutions_;                       /**< @brief Whether improved trajectories are streamed during the optimization */
+  SolutionCallback solution_callback_;
+  utils::TripleBuffer<StreamedSolution> solution_buffer_;
+  unsigned long solve_count_;                   /**< @brief The number of solve() calls so far */
+
+  // background refinement
+  int refinement_iterations_;                   /**< @brief The iterations of the background refinement, zero when disabled */
+  double refinement_time_;                      /**< @brief The time budget of the background refinement in seconds */
+  RefinementCallback refinement_callback_;
+  std::thread refinement_thread_;
+
+  // preemption
+  std::atomic<bool> terminated_;                /**< @brief Set by terminate() until the next clear() */
+
+  // planning statistics
+  PlanningStatisticsPtr statistics_;
+  std::string profile_;                         /**< @brief The planning profile the statistics are recorded under */
+
   // robot model
   moveit::core::RobotModelConstPtr robot_model_;
   utils::kinematics::IKSolverPtr ik_solver_;
@@ -28,9 +28,19 @@
 
 #include <moveit/planning_interface/planning_interface.h>
 #include <ros/node_handle.h>
+#include <stomp_moveit/plan_cache.h>
+#include <stomp_moveit/planning_statistics.h>
+#include <stomp_moveit/rollout_worker_pool.h>
+#include <stomp_moveit/utils/trajectory_library.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 namespace stomp_moveit
 {
+
+class StompPlanner;
+
 /**
  * @class stomp_moveit::StompPlannerManager
  * @brief The PlannerManager implementation that loads STOMP into moveit
@@ -74,7 +84,8 @@ public:
   }
 
   /**
-   * @brief Getter for a list of the available planners, usually one STOMP planner per planning group
+   * @brief Getter for a list of the available planners, the STOMP planner followed by the profile names of all the
+   * planning groups
    * @param algs List of available planners.
    */
   void getPlanningAlgorithms(std::vector<std::string> &algs) const override;
@@ -86,7 +97,25 @@ public:
   void setPlannerConfigurations(const planning_interface::PlannerConfigurationMap &pcs) override;
 
   /**
-   * @brief Provides a planning context that matches the desired plan requests specifications
+   * @brief Getter for the planning groups that STOMP was configured for
+   * @param groups List of planning group names.
+   */
+  void getPlanningGroups(std::vector<std::string> &groups) const;
+
+  /**
+   * @brief Getter for the number of planning contexts created for a planning group
+   * @param group The planning group name
+   * @return The number of planning contexts, 0 if the group is not supported
+   */
+  std::size_t getNumPlanningContexts(const std::string& group) const;
+
+  /**
+   * @brief Provides a planning context that matches the desired plan requests specifications. The context is checked out
+   * of the pool of the profile named by the request's planner_id, or else of the group's default pool, and returned to it
+   * once the last copy of the pointer is released, when all the contexts are in use this waits for one to become
+   * available within the allowed planning time. When the group has a plan cache and the
+   * request matches a cached trajectory that is still valid in the planning scene, a context that returns it is provided
+   * instead.
    * @param planning_scene  A pointer to the planning scene
    * @param req             The motion plan request
    * @param error_code      Error code, will be set to moveit_msgs::MoveItErrorCodes::SUCCESS if it succeeded
@@ -97,12 +126,108 @@ public:
       const planning_interface::MotionPlanRequest &req,
       moveit_msgs::MoveItErrorCodes &error_code) const override;
 
+  /**
+   * @brief Solves many motion plan requests against the same planning scene. The requests of each planning group are
+   * distributed over all of the group's planning contexts, which solve them in parallel.
+   * @param planning_scene  A pointer to the planning scene shared by all the requests
+   * @param requests        The motion plan requests
+   * @param responses       The responses, one per request in the same order
+   * @return True if every request was solved, otherwise false.
+   */
+  bool solveBatch(const planning_scene::PlanningSceneConstPtr &planning_scene,
+                  const std::vector<planning_interface::MotionPlanRequest> &requests,
+                  std::vector<planning_interface::MotionPlanResponse> &responses) const;
+
+  /**
+   * @brief Getter for the latency statistics of the requests solved by the planners of every group and profile
+   * @return The statistics
+   */
+  PlanningStatisticsPtr getPlanningStatistics() const;
+
+
+protected:
+
+  /** @brief The pre-initialized planning contexts of a planning group */
+  struct PlannerPool
+  {
+    std::mutex mutex;
+    std::condition_variable available;
+    std::vector< std::shared_ptr<StompPlanner> > idle;  /**< The planners that are not checked out */
+    std::size_t size;                                   /**< The total number of planners */
+    bool warm_up;                                       /**< Whether the planners are warmed up at startup */
+  };
+
+  /** @brief The trajectory library shared by the planners of a planning group and of its profiles */
+  struct TrajectoryLibraryEntry
+  {
+    utils::TrajectoryLibraryPtr library;
+    std::string file;                                   /**< The file the library was loaded from, empty if none */
+    bool save_on_shutdown;                              /**< Whether the library is written back to its file on destruction */
+  };
+
+  /**
+   * @brief Creates the planners of a pool
+   * @param group         The planning group name
+   * @param profile       The profile name the planners record their statistics under
+   * @param config        The planner parameters
+   * @param num_contexts  The number of planners
+   * @return The pool
+   */
+  std::shared_ptr<PlannerPool> createPlannerPool(const std::string& group, const std::string& profile,
+                                                 XmlRpc::XmlRpcValue& config, int num_contexts) const;
+
+  /**
+   * @brief Creates the trajectory library of a planning group and loads it from its file, if any
+   * @param group   The planning group name
+   * @param config  The 'trajectory_library' parameters
+   * @return True if succeeded, otherwise false.
+   */
+  bool createTrajectoryLibrary(const std::string& group, XmlRpc::XmlRpcValue& config);
+
+  /**
+   * @brief Creates the rollout workers of a planning group, which start their worker processes
+   * @param group   The planning group name
+   * @param config  The group parameters
+   * @return True if succeeded, otherwise false.
+   */
+  bool createRolloutWorkers(const std::string& group, XmlRpc::XmlRpcValue& config);
+
+  /**
+   * @brief Loads the 'stomp_statistics' parameter and starts publishing the statistics periodically
+   * @return True if succeeded, otherwise false.
+   */
+  bool setupPlanningStatistics();
+
+  /**
+   * @brief Publishes the statistics as diagnostics and writes them to the statistics file, if any
+   */
+  void publishPlanningStatistics() const;
+
+  /**
+   * @brief Selects the pool of the profile named by the request's planner_id, either as 'profile' or 'group[profile]',
+   * or the pool with the group's default parameters when the group has no such profile.
+   * @param req The motion plan request
+   * @return The pool
+   */
+  std::shared_ptr<PlannerPool> getPlannerPool(const moveit_msgs::MotionPlanRequest &req) const;
 
 protected:
   ros::NodeHandle nh_;
 
 
   std::map< std::string, planning_interface::PlanningContextPtr> planners_; /**< The planners for each planning group */
+  std::map< std::string, std::shared_ptr<PlannerPool> > planner_pools_;  /**< The pool of planners for each planning group */
+  std::map< std::string, PlanCachePtr> plan_caches_;                      /**< The plan cache of each planning group that enables it */
+  std::map< std::string, TrajectoryLibraryEntry> trajectory_libraries_;   /**< The trajectory library of each planning group that enables it */
+  std::map< std::string, RolloutWorkerPoolPtr> rollout_worker_pools_;     /**< The rollout workers of each planning group that enables them */
+  std::map< std::string, std::map< std::string, std::shared_ptr<PlannerPool> > > profile_pools_; /**< The pool of each profile of each planning group */
+
+  // planning statistics
+  PlanningStatisticsPtr statistics_;
+  ros::Publisher statistics_pub_;
+  ros::WallTimer statistics_timer_;
+  std::string statistics_file_;       /**< The file the statistics are written to, empty if none */
+  std::string trace_file_;           /**< The file the trace is written to when the manager is destroyed, empty if not tracing */
 
   // the robot model
   moveit::core::RobotModelConstPtr robot_model_;
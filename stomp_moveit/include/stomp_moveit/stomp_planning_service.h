@@ -0,0 +1,151 @@
+/**
+ * @file stomp_planning_service.h
+ * @brief This defines a prioritized planning request queue on top of the stomp planner manager
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef STOMP_MOVEIT_STOMP_PLANNING_SERVICE_H_
+#define STOMP_MOVEIT_STOMP_PLANNING_SERVICE_H_
+
+#include <stomp_moveit/stomp_planner_manager.h>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <ros/time.h>
+
+namespace stomp_moveit
+{
+
+/**
+ * @class stomp_moveit::StompPlanningService
+ * @brief Solves motion plan requests asynchronously in order of priority.
+ *
+ * Each planning group gets one worker thread per planning context of the StompPlannerManager, so the optimizers and tasks
+ * are created and warmed up before the first request arrives. Pending requests are served by highest priority first, then
+ * earliest deadline and then arrival order. When all the workers of a group are busy a new request preempts the lowest
+ * priority solve in progress if that one has a lower priority; the preempted solve is cancelled and its request is queued
+ * again.
+ */
+class StompPlanningService
+{
+public:
+  /**
+   * @brief Constructor, starts the worker threads
+   * @param manager An initialized planner manager
+   */
+  StompPlanningService(std::shared_ptr<StompPlannerManager> manager);
+
+  /**
+   * @brief Destructor, cancels the solves in progress and fails the pending requests.
+   */
+  virtual ~StompPlanningService();
+
+  /**
+   * @brief Queues a motion plan request
+   * @param planning_scene  The planning scene, must not be modified while the request is pending
+   * @param req             The motion plan request
+   * @param priority        Requests with a larger value are solved first
+   * @param deadline        The time at which the response is due, the request fails with TIMED_OUT when it can not
+   *                        be started before then. A zero time means that the request only uses its allowed planning time.
+   * @return  The future response
+   */
+  std::future<planning_interface::MotionPlanResponse> submit(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                                             const planning_interface::MotionPlanRequest& req,
+                                                             int priority = 0,
+                                                             ros::WallTime deadline = ros::WallTime());
+
+  /**
+   * @brief Getter for the number of requests waiting to be solved
+   * @return The number of pending requests
+   */
+  std::size_t getNumPending() const;
+
+protected:
+
+  /** @brief A queued motion plan request */
+  struct Job
+  {
+    planning_scene::PlanningSceneConstPtr planning_scene;
+    planning_interface::MotionPlanRequest request;
+    int priority;
+    ros::WallTime deadline;
+    unsigned long sequence;                                                       /**< @brief The arrival order */
+    std::shared_ptr< std::promise<planning_interface::MotionPlanResponse> > response;
+  };
+
+  /** @brief Orders the jobs so that the top of the queue is the next to be solved */
+  struct JobOrder
+  {
+    bool operator()(const Job& a, const Job& b) const;
+  };
+
+  /** @brief The solve in progress of a worker */
+  struct Solve
+  {
+    bool active = false;
+    bool preempted = false;
+    int priority = 0;
+    planning_interface::PlanningContextPtr context;
+  };
+
+  /** @brief The queue and workers of a planning group */
+  struct GroupQueue
+  {
+    std::priority_queue<Job,std::vector<Job>,JobOrder> pending;
+    std::condition_variable available;
+    std::vector<Solve> solves;                                                   /**< @brief One entry per worker */
+    std::vector<std::thread> workers;
+  };
+
+  /**
+   * @brief The worker loop that solves the requests of a group
+   * @param group   The group queue
+   * @param index   The worker index into the group solves
+   */
+  void run(GroupQueue& group, std::size_t index);
+
+  /**
+   * @brief Solves a single request
+   * @param group   The group queue
+   * @param index   The worker index into the group solves
+   * @param job     The request
+   * @param res     The response
+   * @return True when the solve was preempted and the job must be queued again, otherwise false.
+   */
+  bool solve(GroupQueue& group, std::size_t index, Job& job, planning_interface::MotionPlanResponse& res);
+
+  /**
+   * @brief Cancels the lowest priority solve of a group if all workers are busy and it has a lower priority. Requires the lock.
+   * @param group     The group queue
+   * @param priority  The priority of the new request
+   */
+  void preempt(GroupQueue& group, int priority);
+
+protected:
+
+  std::shared_ptr<StompPlannerManager> manager_;
+  std::map<std::string, std::shared_ptr<GroupQueue> > groups_;   /**< @brief The queue of each planning group */
+  mutable std::mutex mutex_;                                      /**< @brief Guards the queues and solves */
+  bool stop_;
+  unsigned long sequence_;
+};
+
+} /* namespace stomp_moveit */
+
+#endif /* STOMP_MOVEIT_STOMP_PLANNING_SERVICE_H_ */
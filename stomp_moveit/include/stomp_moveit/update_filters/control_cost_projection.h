@@ -30,6 +30,7 @@
 
 #include <stomp_moveit/update_filters/stomp_update_filter.h>
 #include <Eigen/Core>
+#include <map>
 
 namespace stomp_moveit
 {
@@ -104,6 +105,7 @@ protected:
   // smoothing matrix
   int num_timesteps_;
   Eigen::MatrixXd projection_matrix_M_;
+  std::map<int,Eigen::MatrixXd> projection_matrices_;   /**< @brief The smoothing matrices computed for each number of timesteps */
 
 };
 
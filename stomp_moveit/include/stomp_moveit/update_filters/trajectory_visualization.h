@@ -32,6 +32,7 @@
 #include <geometry_msgs/Point.h>
 #include <stomp_moveit/update_filters/stomp_update_filter.h>
 #include <visualization_msgs/Marker.h>
+#include <stomp_moveit/utils/robot_state_pool.h>
 
 namespace stomp_moveit
 {
@@ -114,6 +115,7 @@ protected:
   // robot
   std::string group_name_;
   moveit::core::RobotModelConstPtr robot_model_;
+  utils::RobotStatePoolPtr state_pool_;    /**< @brief Hands out the robot states reused across requests */
   moveit::core::RobotStatePtr state_;
 
   // ros comm
@@ -0,0 +1,88 @@
+/**
+ * @file hashing.h
+ * @brief This defines hashing utilities for ros messages and planning scenes
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INCLUDE_STOMP_MOVEIT_UTILS_HASHING_H_
+#define INCLUDE_STOMP_MOVEIT_UTILS_HASHING_H_
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <ros/serialization.h>
+#include <vector>
+
+/**
+ * @namespace stomp_moveit
+ */
+namespace stomp_moveit
+{
+
+/**
+ * @namespace utils
+ */
+namespace utils
+{
+
+/**
+ * @namespace hashing
+ */
+namespace hashing
+{
+
+  const static std::size_t FNV_OFFSET_BASIS = 14695981039346656037ULL;   /**< @brief The initial FNV-1a hash */
+  const static std::size_t FNV_PRIME = 1099511628211ULL;                 /**< @brief The FNV-1a multiplier */
+
+  /**
+   * @brief Computes the FNV-1a hash of a serialized ros message
+   * @param msg   The message
+   * @param hash  The hash to continue from
+   * @return The hash
+   */
+  template <typename M>
+  std::size_t hashMessage(const M& msg, std::size_t hash = FNV_OFFSET_BASIS)
+  {
+    uint32_t size = ros::serialization::serializationLength(msg);
+    std::vector<uint8_t> buffer(size);
+    ros::serialization::OStream stream(buffer.data(),size);
+    ros::serialization::serialize(stream,msg);
+
+    for(uint8_t b : buffer)
+    {
+      hash ^= b;
+      hash *= FNV_PRIME;
+    }
+    return hash;
+  }
+
+  /**
+   * @brief Computes the hash of the planning scene contents: the world objects and octomap, the transforms, the allowed
+   * collisions, the link padding and scaling and the attached objects. The joint values of the robot state are excluded.
+   * @param planning_scene  The planning scene
+   * @param include_octomap Whether the octomap is hashed, serializing it takes longer than the rest of the scene
+   * @return The hash
+   */
+  std::size_t hashPlanningScene(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                bool include_octomap = true);
+
+} // end of namespace hashing
+
+} // end of namespace utils
+
+} // end of namespace stomp_moveit
+
+#endif /* INCLUDE_STOMP_MOVEIT_UTILS_HASHING_H_ */
@@ -44,6 +44,7 @@
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/shared_ptr.hpp>
 #include <cstdlib>
+#include <stomp_core/kernels.h>
 
 namespace stomp_moveit
 {
@@ -75,6 +76,8 @@ private:
   Eigen::VectorXd mean_;                /**< Mean of the gaussian distribution */
   Eigen::MatrixXd covariance_;          /**< Covariance of the gaussian distribution */
   Eigen::MatrixXd covariance_cholesky_; /**< Cholesky decomposition (LL^T) of the covariance */
+  Eigen::VectorXd normal_samples_;      /**< Buffer of standard normal samples */
+  Eigen::VectorXd transformed_samples_; /**< Buffer of the samples transformed by the covariance */
 
   int size_;
   boost::mt19937 rng_;
@@ -94,6 +97,8 @@ MultivariateGaussian::MultivariateGaussian(const Eigen::MatrixBase<Derived1>& me
 
   rng_.seed(rand());
   size_ = mean.rows();
+  normal_samples_.setZero(size_);
+  transformed_samples_.setZero(size_);
   gaussian_.reset(new boost::variate_generator<boost::mt19937, boost::normal_distribution<> >(rng_, normal_dist_));
 }
 
@@ -101,15 +106,22 @@ template <typename Derived>
 void MultivariateGaussian::sample(Eigen::MatrixBase<Derived>& output,bool use_covariance)
 {
   for (int i=0; i<size_; ++i)
-    output(i) = (*gaussian_)();
+    normal_samples_(i) = (*gaussian_)();
 
   if(use_covariance)
   {
-    output = mean_ + covariance_cholesky_*output;
+    // L*z accumulated over the lower triangular columns of L
+    transformed_samples_ = mean_;
+    for (int j=0; j<size_; ++j)
+    {
+      stomp_core::kernels::axpy(normal_samples_(j),covariance_cholesky_.col(j).data() + j,size_ - j,
+                                transformed_samples_.data() + j);
+    }
+    output = transformed_samples_;
   }
   else
   {
-    output = mean_ + output;
+    output = mean_ + normal_samples_;
   }
 }
 
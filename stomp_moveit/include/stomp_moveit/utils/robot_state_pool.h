@@ -0,0 +1,108 @@
+/**
+ * @file robot_state_pool.h
+ * @brief This defines a pool of robot states reused across motion plan requests
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INCLUDE_STOMP_MOVEIT_UTILS_ROBOT_STATE_POOL_H_
+#define INCLUDE_STOMP_MOVEIT_UTILS_ROBOT_STATE_POOL_H_
+
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @namespace stomp_moveit
+ */
+namespace stomp_moveit
+{
+
+/**
+ * @namespace utils
+ */
+namespace utils
+{
+
+class RobotStatePool;
+typedef std::shared_ptr<RobotStatePool> RobotStatePoolPtr;
+
+/**
+ * @brief Keeps the robot states of a robot model that are no longer used so that they can be handed out again. A checked
+ * out state is overwritten in place from a reference state, which reuses its memory, and it returns to the pool when its
+ * last pointer is released. This class is thread-safe.
+ */
+class RobotStatePool : public std::enable_shared_from_this<RobotStatePool>
+{
+public:
+
+  /**
+   * @brief Gets the pool shared by all the users of a robot model, it is created when none exists
+   * @param robot_model The robot model
+   * @return The pool
+   */
+  static RobotStatePoolPtr get(moveit::core::RobotModelConstPtr robot_model);
+
+  /**
+   * @brief Constructor
+   * @param robot_model The robot model of the states
+   */
+  RobotStatePool(moveit::core::RobotModelConstPtr robot_model);
+
+  /**
+   * @brief Checks out a state set to the default values of the robot model
+   * @return The state
+   */
+  moveit::core::RobotStatePtr checkout();
+
+  /**
+   * @brief Checks out a copy of a state
+   * @param source  The state copied, it must belong to the robot model of the pool
+   * @return The state
+   */
+  moveit::core::RobotStatePtr checkout(const moveit::core::RobotState& source);
+
+  /**
+   * @brief Getter for the number of states waiting in the pool
+   * @return The number of states
+   */
+  std::size_t getNumAvailable() const;
+
+protected:
+
+  /**
+   * @brief Puts a released state back into the pool
+   * @param state The state
+   */
+  void checkin(moveit::core::RobotState* state);
+
+protected:
+
+  moveit::core::RobotModelConstPtr robot_model_;
+  std::unique_ptr<const moveit::core::RobotState> default_state_;   /**< @brief The state copied by checkout() */
+
+  mutable std::mutex mutex_;
+  std::vector< std::unique_ptr<moveit::core::RobotState> > available_;
+};
+
+} // end of namespace utils
+
+} // end of namespace stomp_moveit
+
+#endif /* INCLUDE_STOMP_MOVEIT_UTILS_ROBOT_STATE_POOL_H_ */
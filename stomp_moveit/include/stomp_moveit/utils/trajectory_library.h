@@ -0,0 +1,191 @@
+/**
+ * @file trajectory_library.h
+ * @brief This defines a library of previously planned trajectories used to seed new plans
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INCLUDE_STOMP_MOVEIT_UTILS_TRAJECTORY_LIBRARY_H_
+#define INCLUDE_STOMP_MOVEIT_UTILS_TRAJECTORY_LIBRARY_H_
+
+#include <Eigen/Core>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace stomp_moveit
+ */
+namespace stomp_moveit
+{
+
+/**
+ * @namespace utils
+ */
+namespace utils
+{
+
+class TrajectoryLibrary;
+typedef std::shared_ptr<TrajectoryLibrary> TrajectoryLibraryPtr;
+
+/**
+ * @brief Stores successful trajectories of a planning group and finds the one whose start and goal joint values are the
+ * nearest to those of a new request. The trajectories are indexed by their concatenated [start, goal] joint vectors in a
+ * kd-tree. This class is thread-safe.
+ *
+ * The library can be saved to and loaded from a binary file that is memory mapped read-only, so the trajectories of a
+ * file are available without parsing or copying them and the file pages are shared by all the processes that load it.
+ * All the values are in the host byte order and the offsets are from the start of the file:
+ * - header: char magic[8] = "STOMPTL", uint32 version, uint32 num_dimensions, uint64 num_entries,
+ *   uint64 names_offset, uint64 names_size, uint64 entries_offset
+ * - names: the group name and the num_dimensions joint names, each null terminated
+ * - entries: num_entries records of float64 cost, uint32 num_timesteps, uint32 reserved, uint64 data_offset
+ * - data: per entry, float32 start[num_dimensions], float32 goal[num_dimensions] and the column major
+ *   float32 trajectory[num_dimensions][num_timesteps], 8 byte aligned
+ *
+ * The loaded trajectories remain in the library and do not count towards its capacity.
+ */
+class TrajectoryLibrary
+{
+public:
+  /**
+   * @brief Constructor
+   * @param group       The planning group
+   * @param joint_names The names of the joints of the trajectories
+   * @param capacity    The maximum number of added trajectories, the oldest one is replaced when full
+   */
+  TrajectoryLibrary(const std::string& group, const std::vector<std::string>& joint_names, std::size_t capacity);
+
+  /**
+   * @brief Adds a trajectory, the start and goal are taken from its first and last columns
+   * @param trajectory  A matrix [num_dimensions][num_timesteps]
+   * @param cost        The trajectory cost
+   */
+  void add(const Eigen::MatrixXd& trajectory, double cost = 0.0);
+
+  /**
+   * @brief Finds the stored trajectory whose start and goal are the nearest to the given ones
+   * @param start         The start joint values
+   * @param goal          The goal joint values
+   * @param max_distance  The largest euclidean distance between the [start, goal] vectors of a match
+   * @param trajectory    A copy of the nearest trajectory [num_dimensions][num_timesteps]
+   * @return True if a trajectory within max_distance was found, otherwise false.
+   */
+  bool findNearest(const Eigen::VectorXd& start, const Eigen::VectorXd& goal, double max_distance,
+                   Eigen::MatrixXd& trajectory) const;
+
+  /**
+   * @brief Maps a library file and adds its trajectories
+   * @param filename The library file
+   * @return True if succeeded, false if the file could not be mapped or was made for a different group or joints.
+   */
+  bool load(const std::string& filename);
+
+  /**
+   * @brief Writes all the trajectories to a library file. The file is replaced atomically so that the processes that
+   * mapped the previous file are unaffected.
+   * @param filename The library file
+   * @return True if succeeded, otherwise false.
+   */
+  bool save(const std::string& filename) const;
+
+  /**
+   * @brief Getter for the number of stored trajectories
+   * @return The number of trajectories
+   */
+  std::size_t size() const;
+
+protected:
+
+  /** @brief A stored trajectory */
+  struct Entry
+  {
+    Eigen::MatrixXd trajectory;     /**< @brief The added trajectory, empty for mapped ones */
+    const float* data;              /**< @brief The mapped trajectory [num_dimensions][num_timesteps], null for added ones */
+    int num_timesteps;
+    double cost;
+  };
+
+  /** @brief A kd-tree node */
+  struct Node
+  {
+    int entry;    /**< @brief The index of the trajectory */
+    int axis;     /**< @brief The key coordinate that splits the children */
+    int left;     /**< @brief The node with smaller coordinates, -1 if none */
+    int right;    /**< @brief The node with larger or equal coordinates, -1 if none */
+  };
+
+  /** @brief A read-only memory mapped file, unmapped on destruction */
+  struct MappedFile
+  {
+    ~MappedFile();
+    void* address = nullptr;
+    std::size_t size = 0;
+  };
+
+  /**
+   * @brief Rebuilds a balanced tree from all the entries
+   */
+  void rebuild();
+
+  /**
+   * @brief Builds a balanced subtree
+   * @param begin   The first entry of the subtree, the entries are reordered in place
+   * @param end     The end of the subtree entries
+   * @param depth   The depth of the subtree root
+   * @return The index of the root node, -1 if empty
+   */
+  int build(std::vector<int>::iterator begin, std::vector<int>::iterator end, int depth);
+
+  /**
+   * @brief Adds an entry as a leaf of the tree
+   * @param entry The index of the trajectory
+   */
+  void insert(int entry);
+
+  /**
+   * @brief Searches a subtree for the nearest key
+   * @param node          The subtree root
+   * @param key           The query key
+   * @param best          The index of the nearest entry so far
+   * @param best_distance The squared distance to the nearest entry so far
+   */
+  void search(int node, const Eigen::VectorXd& key, int& best, double& best_distance) const;
+
+protected:
+
+  std::string group_;
+  std::vector<std::string> joint_names_;
+  int num_dimensions_;
+  std::size_t capacity_;
+
+  mutable std::mutex mutex_;
+  std::vector<Eigen::VectorXd> keys_;             /**< @brief The [start, goal] key of each trajectory */
+  std::vector<Entry> entries_;                    /**< @brief The stored trajectories */
+  std::vector<int> added_;                        /**< @brief The entries of the added trajectories */
+  std::size_t next_replaced_;                     /**< @brief The index into added_ of the oldest one, replaced next when full */
+  std::vector<Node> nodes_;
+  int root_;
+  std::vector< std::shared_ptr<MappedFile> > files_;
+};
+
+} // end of namespace utils
+
+} // end of namespace stomp_moveit
+
+#endif /* INCLUDE_STOMP_MOVEIT_UTILS_TRAJECTORY_LIBRARY_H_ */
@@ -0,0 +1,113 @@
+/**
+ * @file triple_buffer.h
+ * @brief This defines a lock-free buffer that hands the latest value from one producer to one consumer
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INCLUDE_STOMP_MOVEIT_UTILS_TRIPLE_BUFFER_H_
+#define INCLUDE_STOMP_MOVEIT_UTILS_TRIPLE_BUFFER_H_
+
+#include <array>
+#include <atomic>
+
+/**
+ * @namespace stomp_moveit
+ */
+namespace stomp_moveit
+{
+
+/**
+ * @namespace utils
+ */
+namespace utils
+{
+
+/**
+ * @brief Hands the most recent value from a single producer thread to a single consumer thread without locks. The
+ * producer fills the back buffer and publishes it, the consumer picks up the latest published buffer. Neither side ever
+ * waits for the other and values published in between two pick ups are overwritten.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+  TripleBuffer():
+    back_(0),
+    front_(1),
+    middle_(2)
+  {
+
+  }
+
+  /**
+   * @brief The buffer the producer writes the next value into
+   * @return The back buffer
+   */
+  T& back()
+  {
+    return buffers_[back_];
+  }
+
+  /**
+   * @brief Publishes the back buffer, called by the producer after writing it
+   */
+  void publish()
+  {
+    back_ = middle_.exchange(back_ | PUBLISHED) & INDEX_MASK;
+  }
+
+  /**
+   * @brief Picks up the latest published value, called by the consumer
+   * @return True if a value was published since the last call, otherwise false.
+   */
+  bool update()
+  {
+    if(!(middle_.load() & PUBLISHED))
+    {
+      return false;
+    }
+
+    front_ = middle_.exchange(front_) & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * @brief The buffer holding the value the consumer picked up last
+   * @return The front buffer
+   */
+  const T& front() const
+  {
+    return buffers_[front_];
+  }
+
+protected:
+
+  static const int INDEX_MASK = 0x3;
+  static const int PUBLISHED = 0x4;
+
+  std::array<T,3> buffers_;
+  int back_;                            /**< @brief The buffer owned by the producer */
+  int front_;                           /**< @brief The buffer owned by the consumer */
+  std::atomic<int> middle_;             /**< @brief The buffer in between and whether it holds an unread value */
+};
+
+} // end of namespace utils
+
+} // end of namespace stomp_moveit
+
+#endif /* INCLUDE_STOMP_MOVEIT_UTILS_TRIPLE_BUFFER_H_ */
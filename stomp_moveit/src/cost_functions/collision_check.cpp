@@ -24,12 +24,9 @@
  * limitations under the License.
  */
 #include <ros/console.h>
-#include <pluginlib/class_list_macros.h>
 #include <moveit/robot_state/conversions.h>
 #include "stomp_moveit/cost_functions/collision_check.h"
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::cost_functions::CollisionCheck,stomp_moveit::cost_functions::StompCostFunction)
-
 static const int MIN_KERNEL_WINDOW_SIZE = 3;
 
 /**
@@ -126,7 +123,8 @@ namespace cost_functions
 CollisionCheck::CollisionCheck():
     name_("CollisionCheckPlugin"),
     robot_state_(),
-    collision_penalty_(0.0)
+    collision_penalty_(0.0),
+    num_certificates_(0)
 {
   // TODO Auto-generated constructor stub
 
@@ -141,6 +139,7 @@ bool CollisionCheck::initialize(moveit::core::RobotModelConstPtr robot_model_ptr
                         const std::string& group_name,XmlRpc::XmlRpcValue& config)
 {
   robot_model_ptr_ = robot_model_ptr;
+  state_pool_ = utils::RobotStatePool::get(robot_model_ptr);
   group_name_ = group_name;
   return configure(config);
 }
@@ -169,7 +168,7 @@ bool CollisionCheck::setMotionPlanRequest(const planning_scene::PlanningSceneCon
   collision_world_ = planning_scene->getCollisionWorld();
 
   // storing robot state
-  robot_state_.reset(new RobotState(robot_model_ptr_));
+  robot_state_ = state_pool_->checkout();
   if(!robotStateMsgToRobotState(req.start_state,*robot_state_,true))
   {
     ROS_ERROR("%s Failed to get current robot state from request",getName().c_str());
@@ -179,12 +178,15 @@ bool CollisionCheck::setMotionPlanRequest(const planning_scene::PlanningSceneCon
   // copying into intermediate robot states
   for(auto& rs : intermediate_coll_states_)
   {
-    rs.reset(new RobotState(*robot_state_));
+    rs = state_pool_->checkout(*robot_state_);
   }
 
   // allocating arrays
   raw_costs_ = Eigen::VectorXd::Zero(config.num_timesteps);
 
+  // certificates from a previous request do not apply
+  num_certificates_ = 0;
+
 
   return true;
 }
@@ -286,6 +288,18 @@ bool CollisionCheck::computeCosts(const Eigen::MatrixXd& parameters,
     }
   }
 
+  // certifying the full optimized trajectory when collision free
+  if(validity && rollout_number == getOptimizedIndex() && start_timestep == 0 &&
+     num_timesteps == static_cast<std::size_t>(parameters.cols()))
+  {
+    std::swap(certificates_[0],certificates_[1]);
+    ValidityCertificate& c = certificates_[0];
+    c.planning_scene = planning_scene_;
+    c.waypoints = parameters;
+    c.segment_resolution = longest_valid_joint_move_;
+    num_certificates_ = std::min<std::size_t>(num_certificates_ + 1,certificates_.size());
+  }
+
   // applying kernel smoothing
   if(!validity)
   {
@@ -358,6 +372,11 @@ bool CollisionCheck::checkIntermediateCollisions(const Eigen::VectorXd& start,
   return true;
 }
 
+void CollisionCheck::getValidityCertificates(std::vector<ValidityCertificate>& certificates) const
+{
+  certificates.insert(certificates.end(),certificates_.begin(),certificates_.begin() + num_certificates_);
+}
+
 bool CollisionCheck::configure(const XmlRpc::XmlRpcValue& config)
 {
 
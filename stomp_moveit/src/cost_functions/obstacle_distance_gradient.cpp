@@ -26,10 +26,8 @@
 
 #include <stomp_moveit/cost_functions/obstacle_distance_gradient.h>
 #include <ros/console.h>
-#include <pluginlib/class_list_macros.h>
 #include <moveit/robot_state/conversions.h>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::cost_functions::ObstacleDistanceGradient,stomp_moveit::cost_functions::StompCostFunction)
 static const double LONGEST_VALID_JOINT_MOVE = 0.01;
 
 namespace stomp_moveit
@@ -53,6 +51,7 @@ bool ObstacleDistanceGradient::initialize(moveit::core::RobotModelConstPtr robot
                                           const std::string& group_name, XmlRpc::XmlRpcValue& config)
 {
   robot_model_ptr_ = robot_model_ptr;
+  state_pool_ = utils::RobotStatePool::get(robot_model_ptr);
   group_name_ = group_name;
   collision_request_.distance = true;
   collision_request_.group_name = group_name;
@@ -111,7 +110,7 @@ bool ObstacleDistanceGradient::setMotionPlanRequest(const planning_scene::Planni
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
 
   // storing robot state
-  robot_state_.reset(new RobotState(robot_model_ptr_));
+  robot_state_ = state_pool_->checkout();
 
   if(!robotStateMsgToRobotState(req.start_state,*robot_state_,true))
   {
@@ -122,7 +121,7 @@ bool ObstacleDistanceGradient::setMotionPlanRequest(const planning_scene::Planni
   // copying into intermediate robot states
   for(auto& rs : intermediate_coll_states_)
   {
-    rs.reset(new RobotState(*robot_state_));
+    rs = state_pool_->checkout(*robot_state_);
   }
 
   return true;
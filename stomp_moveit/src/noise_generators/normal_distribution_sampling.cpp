@@ -26,11 +26,8 @@
 #include <stomp_moveit/noise_generators/normal_distribution_sampling.h>
 #include <stomp_moveit/utils/multivariate_gaussian.h>
 #include <XmlRpcException.h>
-#include <pluginlib/class_list_macros.h>
 #include <ros/console.h>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::noise_generators::NormalDistributionSampling,stomp_moveit::noise_generators::StompNoiseGenerator);
-
 /*
  * These coefficients correspond to the five point stencil method
  */
@@ -118,8 +115,21 @@ bool NormalDistributionSampling::setMotionPlanRequest(const planning_scene::Plan
     m.diagonal(diag_index) = VectorXd::Constant(size,coeff);
   };
 
-  // creating finite difference acceleration matrix
-  std::size_t num_timesteps = config.num_timesteps;
+  // creating finite difference acceleration matrix, the noise is generated for each optimized parameter
+  std::size_t num_timesteps = stomp_core::getNumParameters(config);
+
+  // preallocating noise data
+  raw_noise_.resize(num_timesteps);
+  raw_noise_.setZero();
+
+  // reusing the generators from a previous request of the same size
+  auto cached = rand_generators_cache_.find(num_timesteps);
+  if(cached != rand_generators_cache_.end())
+  {
+    rand_generators_ = cached->second;
+    return true;
+  }
+
   Eigen::MatrixXd A = MatrixXd::Zero(num_timesteps,num_timesteps);
   int num_elements = (int((ACC_MATRIX_DIAGONAL_INDICES.size() -1)/2.0) + 1)* num_timesteps ;
   for(auto i = 0u; i < ACC_MATRIX_DIAGONAL_INDICES.size() ; i++)
@@ -140,10 +150,7 @@ bool NormalDistributionSampling::setMotionPlanRequest(const planning_scene::Plan
   {
     r.reset(new utils::MultivariateGaussian(VectorXd::Zero(num_timesteps),covariance));
   }
-
-  // preallocating noise data
-  raw_noise_.resize(config.num_timesteps);
-  raw_noise_.setZero();
+  rand_generators_cache_[num_timesteps] = rand_generators_;
 
   return true;
 }
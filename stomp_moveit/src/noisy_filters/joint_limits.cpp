@@ -24,12 +24,9 @@
  * limitations under the License.
  */
 #include <ros/console.h>
-#include <pluginlib/class_list_macros.h>
 #include <moveit/robot_state/conversions.h>
 #include <stomp_moveit/noisy_filters/joint_limits.h>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::noisy_filters::JointLimits,stomp_moveit::noisy_filters::StompNoisyFilter);
-
 namespace stomp_moveit
 {
 namespace noisy_filters
@@ -25,12 +25,9 @@
  */
 #include <moveit/robot_state/conversions.h>
 #include <tf/transform_datatypes.h>
-#include <pluginlib/class_list_macros.h>
 #include <stomp_moveit/noisy_filters/multi_trajectory_visualization.h>
 #include <eigen_conversions/eigen_msg.h>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::noisy_filters::MultiTrajectoryVisualization,stomp_moveit::noisy_filters::StompNoisyFilter);
-
 inline void eigenToPointsMsgs(const Eigen::MatrixXd& in,std::vector<geometry_msgs::Point>& out)
 {
   // resizing
@@ -110,6 +107,7 @@ bool MultiTrajectoryVisualization::initialize(moveit::core::RobotModelConstPtr r
                         const std::string& group_name,const XmlRpc::XmlRpcValue& config)
 {
   robot_model_ = robot_model_ptr;
+  state_pool_ = utils::RobotStatePool::get(robot_model_ptr);
   group_name_ = group_name;
 
   if(!configure(config))
@@ -197,7 +195,7 @@ bool MultiTrajectoryVisualization::setMotionPlanRequest(const planning_scene::Pl
 
 
   // updating state
-  state_.reset(new RobotState(robot_model_));
+  state_ = state_pool_->checkout();
   if(!robotStateMsgToRobotState(req.start_state,*state_,true))
   {
     ROS_ERROR("%s Failed to get current robot state from request",getName().c_str());
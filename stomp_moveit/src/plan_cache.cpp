@@ -0,0 +1,281 @@
+/**
+ * @file plan_cache.cpp
+ * @brief This defines a cache of the plans found for repeated motion plan requests
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stomp_moveit/plan_cache.h>
+#include <stomp_moveit/utils/hashing.h>
+#include <moveit/robot_state/conversions.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+static const double DEFAULT_JOINT_RESOLUTION = 1e-4;
+
+namespace stomp_moveit
+{
+
+bool PlanCache::Key::operator<(const Key& other) const
+{
+  return std::tie(scene_hash,request_hash,start) < std::tie(other.scene_hash,other.request_hash,other.start);
+}
+
+PlanCache::PlanCache(const std::string& group, const XmlRpc::XmlRpcValue& config):
+    group_(group),
+    capacity_(0),
+    joint_resolution_(DEFAULT_JOINT_RESOLUTION),
+    scene_hash_(0)
+{
+  XmlRpc::XmlRpcValue c = config;
+  capacity_ = static_cast<int>(c["capacity"]);
+  if(c.hasMember("joint_resolution"))
+  {
+    joint_resolution_ = static_cast<double>(c["joint_resolution"]);
+  }
+
+  if(joint_resolution_ <= 0.0)
+  {
+    throw std::logic_error("Stomp 'plan_cache/joint_resolution' parameter for group '" + group_ + "' must be positive");
+  }
+}
+
+bool PlanCache::computeKey(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                           const moveit_msgs::MotionPlanRequest& req, Key& key)
+{
+  using namespace utils::hashing;
+
+  auto quantize = [this](double v) -> long
+  {
+    return std::lround(v/joint_resolution_);
+  };
+
+  // start joint values
+  moveit::core::RobotState start_state(planning_scene->getCurrentState());
+  if(!moveit::core::robotStateMsgToRobotState(req.start_state,start_state))
+  {
+    return false;
+  }
+
+  std::vector<double> start;
+  start_state.copyJointGroupPositions(group_,start);
+  key.start.resize(start.size());
+  std::transform(start.begin(),start.end(),key.start.begin(),quantize);
+
+  // the constraint headers only keep their frame, a repeated request is usually stamped again
+  auto clear_stamps = [](moveit_msgs::Constraints& c)
+  {
+    auto clear_stamp = [](std_msgs::Header& header)
+    {
+      header.stamp = ros::Time();
+      header.seq = 0;
+    };
+
+    for(auto& pc : c.position_constraints)
+    {
+      clear_stamp(pc.header);
+    }
+    for(auto& oc : c.orientation_constraints)
+    {
+      clear_stamp(oc.header);
+    }
+    for(auto& vc : c.visibility_constraints)
+    {
+      clear_stamp(vc.target_pose.header);
+      clear_stamp(vc.sensor_pose.header);
+    }
+  };
+
+  // goal and path constraints with the joint values quantized
+  std::vector<moveit_msgs::Constraints> goals = req.goal_constraints;
+  for(auto& g : goals)
+  {
+    for(auto& jc : g.joint_constraints)
+    {
+      jc.position = quantize(jc.position) * joint_resolution_;
+    }
+    clear_stamps(g);
+  }
+
+  moveit_msgs::Constraints path_constraints = req.path_constraints;
+  clear_stamps(path_constraints);
+  moveit_msgs::TrajectoryConstraints trajectory_constraints = req.trajectory_constraints;
+  for(auto& c : trajectory_constraints.constraints)
+  {
+    clear_stamps(c);
+  }
+
+  std::size_t hash = hashMessage(goals);
+  hash = hashMessage(path_constraints,hash);
+  hash = hashMessage(trajectory_constraints,hash);
+  hash = hashMessage(req.max_velocity_scaling_factor,hash);
+  hash = hashMessage(req.planner_id,hash);
+  key.request_hash = hash;
+
+  // scene contents, excluding the robot state which only matters through the start state. The octomap is left out
+  // since serializing it can take longer than the solve, a cached plan is checked against it before being returned.
+  key.scene_hash = hashPlanningScene(planning_scene,false);
+
+  return true;
+}
+
+bool PlanCache::lookup(const Key& key, moveit_msgs::RobotTrajectory& trajectory)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto i = index_.find(key);
+  if(i == index_.end())
+  {
+    return false;
+  }
+
+  entries_.splice(entries_.begin(),entries_,i->second);
+  trajectory = i->second->second;
+  return true;
+}
+
+void PlanCache::insert(const Key& key, const moveit_msgs::RobotTrajectory& trajectory)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(capacity_ == 0)
+  {
+    return;
+  }
+
+  // trajectories planned in a different scene are no longer reusable
+  if(key.scene_hash != scene_hash_)
+  {
+    ROS_DEBUG("STOMP plan cache for group '%s' cleared after a planning scene change",group_.c_str());
+    entries_.clear();
+    index_.clear();
+    scene_hash_ = key.scene_hash;
+  }
+
+  auto i = index_.find(key);
+  if(i != index_.end())
+  {
+    entries_.erase(i->second);
+    index_.erase(i);
+  }
+
+  entries_.push_front(std::make_pair(key,trajectory));
+  index_[key] = entries_.begin();
+
+  if(entries_.size() > capacity_)
+  {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+void PlanCache::erase(const Key& key)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto i = index_.find(key);
+  if(i != index_.end())
+  {
+    entries_.erase(i->second);
+    index_.erase(i);
+  }
+}
+
+PlanCacheContext::PlanCacheContext(const std::string& name, const std::string& group,
+                                   robot_trajectory::RobotTrajectoryPtr trajectory):
+    PlanningContext(name,group),
+    trajectory_(trajectory)
+{
+
+}
+
+PlanCacheContext::PlanCacheContext(planning_interface::PlanningContextPtr planner, PlanCachePtr cache,
+                                   const PlanCache::Key& key):
+    PlanningContext(planner->getName(),planner->getGroupName()),
+    planner_(planner),
+    cache_(cache),
+    key_(key)
+{
+
+}
+
+PlanCacheContext::~PlanCacheContext()
+{
+
+}
+
+bool PlanCacheContext::solve(planning_interface::MotionPlanResponse &res)
+{
+  if(!planner_)
+  {
+    res.trajectory_ = trajectory_;
+    res.planning_time_ = 0.0;
+    res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+    return true;
+  }
+
+  bool success = planner_->solve(res);
+  if(success && res.error_code_.val == moveit_msgs::MoveItErrorCodes::SUCCESS)
+  {
+    store(res.trajectory_);
+  }
+  return success;
+}
+
+bool PlanCacheContext::solve(planning_interface::MotionPlanDetailedResponse &res)
+{
+  if(!planner_)
+  {
+    res.trajectory_.assign(1,trajectory_);
+    res.description_.assign(1,"");
+    res.processing_time_.assign(1,0.0);
+    res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+    return true;
+  }
+
+  bool success = planner_->solve(res);
+  if(success && res.error_code_.val == moveit_msgs::MoveItErrorCodes::SUCCESS && !res.trajectory_.empty())
+  {
+    store(res.trajectory_.back());
+  }
+  return success;
+}
+
+bool PlanCacheContext::terminate()
+{
+  return planner_ ? planner_->terminate() : true;
+}
+
+void PlanCacheContext::clear()
+{
+  if(planner_)
+  {
+    planner_->clear();
+  }
+}
+
+void PlanCacheContext::store(const robot_trajectory::RobotTrajectoryPtr& trajectory)
+{
+  if(!trajectory)
+  {
+    return;
+  }
+
+  moveit_msgs::RobotTrajectory msg;
+  trajectory->getRobotTrajectoryMsg(msg);
+  cache_->insert(key_,msg);
+}
+
+} /* namespace stomp_moveit */
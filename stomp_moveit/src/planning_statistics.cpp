@@ -0,0 +1,320 @@
+/**
+ * @file planning_statistics.cpp
+ * @brief This defines the latency and outcome statistics of the motion plan requests solved by STOMP
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stomp_moveit/planning_statistics.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+static const double HISTOGRAM_MIN_VALUE = 1e-4;
+static const int HISTOGRAM_NUM_DECADES = 8;
+static const int HISTOGRAM_BINS_PER_DECADE = 10;
+static const double SUMMARY_PERCENTILES[] = {0.5, 0.9, 0.99};
+static const char* SUMMARY_PERCENTILE_NAMES[] = {"p50", "p90", "p99"};
+
+namespace stomp_moveit
+{
+
+Histogram::Histogram():
+    bins_(HISTOGRAM_NUM_DECADES * HISTOGRAM_BINS_PER_DECADE,0),
+    count_(0),
+    sum_(0.0),
+    min_(std::numeric_limits<double>::max()),
+    max_(0.0)
+{
+
+}
+
+void Histogram::add(double value)
+{
+  value = std::max(value,0.0);
+  int bin = value > HISTOGRAM_MIN_VALUE ?
+      static_cast<int>(std::ceil(std::log10(value/HISTOGRAM_MIN_VALUE)*HISTOGRAM_BINS_PER_DECADE)) - 1 : 0;
+  bins_[std::min<std::size_t>(std::max(bin,0),bins_.size() - 1)]++;
+
+  count_++;
+  sum_ += value;
+  min_ = std::min(min_,value);
+  max_ = std::max(max_,value);
+}
+
+std::size_t Histogram::getCount() const
+{
+  return count_;
+}
+
+double Histogram::getMean() const
+{
+  return count_ > 0 ? sum_/count_ : 0.0;
+}
+
+double Histogram::getMax() const
+{
+  return max_;
+}
+
+double Histogram::getPercentile(double p) const
+{
+  if(count_ == 0)
+  {
+    return 0.0;
+  }
+
+  // the bin holding the value with this many values at or below it
+  std::size_t rank = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(p*count_)),1);
+  std::size_t cumulative = 0;
+  std::size_t bin = 0;
+  for(; bin < bins_.size() - 1; bin++)
+  {
+    cumulative += bins_[bin];
+    if(cumulative >= rank)
+    {
+      break;
+    }
+  }
+
+  double upper_edge = HISTOGRAM_MIN_VALUE * std::pow(10.0,static_cast<double>(bin + 1)/HISTOGRAM_BINS_PER_DECADE);
+  return std::min(std::max(upper_edge,min_),max_);
+}
+
+PlanningStatistics::Recorder::Recorder(const PlanningStatisticsPtr& statistics, const std::string& group,
+                                       const std::string& profile):
+    statistics_(statistics),
+    phase_(-1)
+{
+  if(!statistics_)
+  {
+    return;
+  }
+
+  group_ = group;
+  profile_ = profile;
+  sample_.durations.fill(0.0);
+  start_time_ = Clock::now();
+}
+
+PlanningStatistics::Recorder::~Recorder()
+{
+  if(!statistics_)
+  {
+    return;
+  }
+
+  endPhase();
+  sample_.durations[TOTAL] = std::chrono::duration<double>(Clock::now() - start_time_).count();
+  statistics_->record(group_,profile_,sample_);
+}
+
+void PlanningStatistics::Recorder::startPhase(Phase phase)
+{
+  if(!statistics_)
+  {
+    return;
+  }
+
+  endPhase();
+  phase_ = phase;
+  phase_start_time_ = Clock::now();
+}
+
+void PlanningStatistics::Recorder::endPhase()
+{
+  if(!statistics_ || phase_ < 0)
+  {
+    return;
+  }
+
+  sample_.durations[phase_] += std::chrono::duration<double>(Clock::now() - phase_start_time_).count();
+  phase_ = -1;
+}
+
+void PlanningStatistics::Recorder::setIterations(int iterations)
+{
+  sample_.iterations = iterations;
+}
+
+void PlanningStatistics::Recorder::setSuccess(bool success)
+{
+  sample_.success = success;
+}
+
+PlanningStatistics::PlanningStatistics(double latency_objective, double objective_percentile):
+    latency_objective_(latency_objective),
+    objective_percentile_(objective_percentile)
+{
+
+}
+
+const char* PlanningStatistics::getPhaseName(Phase phase)
+{
+  static const char* names[NUM_PHASES] = {"setup", "optimization", "time_parameterization", "validation", "total"};
+  return names[phase];
+}
+
+void PlanningStatistics::record(const std::string& group, const std::string& profile, const Sample& sample)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry& e = entries_[std::make_pair(group,profile)];
+  e.num_requests++;
+  if(sample.iterations > 0)
+  {
+    e.iterations.add(sample.iterations);
+  }
+  if(sample.success)
+  {
+    e.num_successes++;
+    if(latency_objective_ > 0.0 && sample.durations[TOTAL] <= latency_objective_)
+    {
+      e.num_within_objective++;
+    }
+  }
+
+  // only the phases a request reached are counted
+  for(int p = 0; p < NUM_PHASES; p++)
+  {
+    if(sample.durations[p] > 0.0)
+    {
+      e.latencies[p].add(sample.durations[p]);
+    }
+  }
+}
+
+void PlanningStatistics::getDiagnostics(diagnostic_msgs::DiagnosticArray& msg) const
+{
+  auto key_value = [](const std::string& key, double value)
+  {
+    diagnostic_msgs::KeyValue kv;
+    kv.key = key;
+    std::ostringstream ss;
+    ss << value;
+    kv.value = ss.str();
+    return kv;
+  };
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  msg.status.clear();
+  for(const auto& v : entries_)
+  {
+    const Entry& e = v.second;
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = "stomp: " + v.first.first + "[" + v.first.second + "]";
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message = "OK";
+
+    double success_rate = static_cast<double>(e.num_successes)/e.num_requests;
+    status.values.push_back(key_value("requests",e.num_requests));
+    status.values.push_back(key_value("success_rate",success_rate));
+    if(latency_objective_ > 0.0)
+    {
+      double attainment = static_cast<double>(e.num_within_objective)/e.num_requests;
+      status.values.push_back(key_value("latency_objective",latency_objective_));
+      status.values.push_back(key_value("within_objective",attainment));
+      if(attainment < objective_percentile_)
+      {
+        status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+        status.message = "Latency objective missed";
+      }
+    }
+
+    for(int i = 0; i < 3; i++)
+    {
+      status.values.push_back(key_value(std::string("iterations_") + SUMMARY_PERCENTILE_NAMES[i],
+                                        e.iterations.getPercentile(SUMMARY_PERCENTILES[i])));
+    }
+
+    for(int p = 0; p < NUM_PHASES; p++)
+    {
+      const Histogram& h = e.latencies[p];
+      std::string name = getPhaseName(static_cast<Phase>(p));
+      for(int i = 0; i < 3; i++)
+      {
+        status.values.push_back(key_value(name + "_" + SUMMARY_PERCENTILE_NAMES[i],
+                                          h.getPercentile(SUMMARY_PERCENTILES[i])));
+      }
+      status.values.push_back(key_value(name + "_max",h.getMax()));
+    }
+
+    msg.status.push_back(status);
+  }
+}
+
+bool PlanningStatistics::save(const std::string& filename) const
+{
+  auto write_histogram = [](std::ostream& out, const std::string& name, const Histogram& h)
+  {
+    out << "    " << name << ": {count: " << h.getCount() << ", mean: " << h.getMean();
+    for(int i = 0; i < 3; i++)
+    {
+      out << ", " << SUMMARY_PERCENTILE_NAMES[i] << ": " << h.getPercentile(SUMMARY_PERCENTILES[i]);
+    }
+    out << ", max: " << h.getMax() << "}\n";
+  };
+
+  std::ostringstream out;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string group;
+    for(const auto& v : entries_)
+    {
+      const Entry& e = v.second;
+      if(v.first.first != group)
+      {
+        group = v.first.first;
+        out << group << ":\n";
+      }
+
+      out << "  " << v.first.second << ":\n";
+      out << "    requests: " << e.num_requests << "\n";
+      out << "    successes: " << e.num_successes << "\n";
+      out << "    success_rate: " << static_cast<double>(e.num_successes)/e.num_requests << "\n";
+      if(latency_objective_ > 0.0)
+      {
+        out << "    latency_objective: " << latency_objective_ << "\n";
+        out << "    within_objective: " << static_cast<double>(e.num_within_objective)/e.num_requests << "\n";
+      }
+
+      write_histogram(out,"iterations",e.iterations);
+      for(int p = 0; p < NUM_PHASES; p++)
+      {
+        write_histogram(out,getPhaseName(static_cast<Phase>(p)),e.latencies[p]);
+      }
+    }
+  }
+
+  // writing next to the destination and renaming it so that readers never see a partial file
+  std::string tmp_filename = filename + ".tmp";
+  std::ofstream file(tmp_filename,std::ios::trunc);
+  file << out.str();
+  file.close();
+  if(!file || std::rename(tmp_filename.c_str(),filename.c_str()) != 0)
+  {
+    ROS_ERROR("Planning statistics file '%s' could not be written",filename.c_str());
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+} /* namespace stomp_moveit */
@@ -0,0 +1,196 @@
+/**
+ * @file rollout_worker.cpp
+ * @brief This defines the worker process that evaluates the costs of noisy rollouts for a RolloutWorkerPool
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stomp_moveit/rollout_worker_pool.h>
+#include <stomp_moveit/stomp_optimization_task.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <ros/ros.h>
+#include <ros/serialization.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static const int PARENT_CHECK_PERIOD = 1;  // seconds between checks of the planner process while idle
+
+using namespace stomp_moveit;
+
+/**
+ * @brief Deserializes a ros message from the shared memory
+ * @param memory  The shared memory
+ * @param offset  The offset of the message
+ * @param size    The serialized size of the message
+ * @param msg     The message
+ */
+template <typename M>
+void deserialize(char* memory, uint64_t offset, uint64_t size, M& msg)
+{
+  ros::serialization::IStream stream(reinterpret_cast<uint8_t*>(memory + offset),size);
+  ros::serialization::deserialize(stream,msg);
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc,argv,"stomp_rollout_worker",ros::init_options::AnonymousName | ros::init_options::NoSigintHandler);
+  if(argc != 5)
+  {
+    ROS_ERROR("Usage: stomp_rollout_worker <shared memory> <group> <robot description> <planner pid>");
+    return 1;
+  }
+
+  std::string shared_memory_name = argv[1];
+  std::string group = argv[2];
+  std::string robot_description = argv[3];
+  pid_t parent = std::stoi(argv[4]);
+
+  // exiting along with the planner, which is polled while idle since PR_SET_PDEATHSIG fires when the spawning thread
+  // exits and the workers are spawned from the planning threads
+  if(getppid() != parent)
+  {
+    return 1;
+  }
+
+  // mapping the shared memory
+  int fd = shm_open(shared_memory_name.c_str(),O_RDWR,0);
+  struct stat file_stat;
+  if(fd < 0 || fstat(fd,&file_stat) != 0)
+  {
+    ROS_ERROR("Stomp rollout worker failed to open the shared memory '%s'",shared_memory_name.c_str());
+    return 1;
+  }
+
+  void* shared_memory = mmap(nullptr,file_stat.st_size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+  close(fd);
+  if(shared_memory == MAP_FAILED)
+  {
+    ROS_ERROR("Stomp rollout worker failed to map the shared memory '%s'",shared_memory_name.c_str());
+    return 1;
+  }
+  char* memory = static_cast<char*>(shared_memory);
+  RolloutWorkerHeader* header = static_cast<RolloutWorkerHeader*>(shared_memory);
+
+  // loading the robot model and the plugins
+  robot_model_loader::RobotModelLoader loader(robot_description,false);
+  moveit::core::RobotModelConstPtr robot_model = loader.getModel();
+  if(!robot_model)
+  {
+    ROS_ERROR("Stomp rollout worker failed to load the robot model from '%s'",robot_description.c_str());
+    return 1;
+  }
+
+  std::shared_ptr<StompOptimizationTask> task;
+  try
+  {
+    int offset = 0;
+    XmlRpc::XmlRpcValue config(std::string(memory + header->config_offset,header->config_size),&offset);
+    task = std::make_shared<StompOptimizationTask>(robot_model,group,config);
+  }
+  catch(std::exception& e)
+  {
+    ROS_ERROR("Stomp rollout worker failed to load the plugins of group '%s': %s",group.c_str(),e.what());
+    return 1;
+  }
+
+  planning_scene::PlanningScenePtr planning_scene(new planning_scene::PlanningScene(robot_model));
+  uint64_t scene_version = 0;
+  uint64_t request_version = 0;
+  bool request_valid = false;
+  Eigen::MatrixXd parameters;
+  Eigen::VectorXd costs;
+
+  header->num_ready++;
+
+  while(true)
+  {
+    timespec wake;
+    clock_gettime(CLOCK_REALTIME,&wake);
+    wake.tv_sec += PARENT_CHECK_PERIOD;
+    if(sem_timedwait(&header->jobs_posted,&wake) != 0)
+    {
+      if(getppid() != parent)
+      {
+        return 0;
+      }
+      continue;
+    }
+
+    uint32_t j = header->next_job++;
+    RolloutJob* job = reinterpret_cast<RolloutJob*>(memory + header->jobs_offset + j * header->job_size);
+    bool computed = false;
+    try
+    {
+      // catching up with the planning scene and request of the planner
+      if(header->request_version != request_version)
+      {
+        request_version = header->request_version;
+        request_valid = false;
+        if(header->scene_version != 0 && header->request_size != 0)
+        {
+          if(header->scene_version != scene_version)
+          {
+            moveit_msgs::PlanningScene scene_msg;
+            deserialize(memory,header->scene_offset,header->scene_size,scene_msg);
+            planning_scene->setPlanningSceneMsg(scene_msg);
+            scene_version = header->scene_version;
+          }
+
+          moveit_msgs::MotionPlanRequest req;
+          moveit_msgs::MoveItErrorCodes error_code;
+          deserialize(memory,header->request_offset,header->request_size,req);
+          request_valid = task->setMotionPlanRequest(planning_scene,req,header->stomp_config,error_code);
+        }
+      }
+
+      if(request_valid)
+      {
+        double* data = reinterpret_cast<double*>(job + 1);
+        parameters = Eigen::Map<Eigen::MatrixXd>(data,header->num_dimensions,header->num_parameters);
+
+        bool valid;
+        computed = task->computeNoisyCosts(parameters,header->start_timestep,header->num_timesteps,
+                                           header->iteration_number,job->rollout_number,costs,valid);
+        if(computed)
+        {
+          Eigen::Map<Eigen::VectorXd>(data + parameters.size(),header->num_timesteps) = costs;
+          job->valid = valid;
+        }
+      }
+    }
+    catch(std::exception& e)
+    {
+      ROS_ERROR("Stomp rollout worker failed to evaluate rollout %i: %s",job->rollout_number,e.what());
+    }
+
+    if(!computed)
+    {
+      header->num_failed++;
+    }
+
+    if(header->num_done.fetch_add(1) + 1 == header->num_jobs)
+    {
+      sem_post(&header->batch_done);
+    }
+  }
+
+  return 0;
+}
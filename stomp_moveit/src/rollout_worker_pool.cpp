@@ -0,0 +1,480 @@
+/**
+ * @file rollout_worker_pool.cpp
+ * @brief This defines a pool of worker processes that evaluate the costs of the noisy rollouts
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stomp_moveit/rollout_worker_pool.h>
+#include <stomp_moveit/utils/hashing.h>
+#include <ros/console.h>
+#include <ros/names.h>
+#include <ros/serialization.h>
+#include <ros/time.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+extern char** environ;
+
+static const std::size_t DEFAULT_SHARED_MEMORY_SIZE = 64;   // MB
+static const double DEFAULT_TIMEOUT = 5.0;
+static const double WAIT_PERIOD = 0.1;                      // seconds between checks of the workers while waiting
+static const std::size_t ALIGNMENT = 64;
+static const std::string WORKER_EXECUTABLE = "stomp_rollout_worker";
+
+static std::size_t align(std::size_t offset)
+{
+  return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+/**
+ * @brief Computes the time a number of seconds from now
+ * @param seconds The seconds
+ * @return The time as used by sem_timedwait()
+ */
+static timespec timeFromNow(double seconds)
+{
+  timespec t;
+  clock_gettime(CLOCK_REALTIME,&t);
+  long nsec = t.tv_nsec + static_cast<long>((seconds - static_cast<long>(seconds)) * 1e9);
+  t.tv_sec += static_cast<long>(seconds) + nsec / 1000000000L;
+  t.tv_nsec = nsec % 1000000000L;
+  return t;
+}
+
+/**
+ * @brief Finds the worker executable, which is installed into the package directory next to this library
+ * @return The path of the executable
+ */
+static std::string findWorkerExecutable()
+{
+  Dl_info info;
+  if(!dladdr(reinterpret_cast<void*>(&findWorkerExecutable),&info) || !info.dli_fname)
+  {
+    return WORKER_EXECUTABLE;
+  }
+
+  std::string library = info.dli_fname;
+  std::size_t pos = library.rfind('/');
+  std::string library_dir = pos == std::string::npos ? "." : library.substr(0,pos);
+  return library_dir + "/stomp_moveit/" + WORKER_EXECUTABLE;
+}
+
+namespace stomp_moveit
+{
+
+RolloutWorkerPool::RolloutWorkerPool(const std::string& group, const XmlRpc::XmlRpcValue& task_config,
+                                     const XmlRpc::XmlRpcValue& config):
+    group_(group),
+    num_workers_(0),
+    shared_memory_size_(DEFAULT_SHARED_MEMORY_SIZE << 20),
+    timeout_(DEFAULT_TIMEOUT),
+    robot_description_("robot_description"),
+    shared_memory_(nullptr),
+    header_(nullptr)
+{
+  // parsing parameters
+  XmlRpc::XmlRpcValue c = config;
+  int num_workers = static_cast<int>(c["num_workers"]);
+  if(c.hasMember("shared_memory_size"))
+  {
+    shared_memory_size_ = static_cast<std::size_t>(static_cast<int>(c["shared_memory_size"])) << 20;
+  }
+
+  if(c.hasMember("timeout"))
+  {
+    timeout_ = static_cast<double>(c["timeout"]);
+  }
+
+  if(c.hasMember("robot_description"))
+  {
+    robot_description_ = static_cast<std::string>(c["robot_description"]);
+  }
+
+  executable_ = c.hasMember("executable") ? static_cast<std::string>(c["executable"]) : findWorkerExecutable();
+
+  if(num_workers < 1 || shared_memory_size_ == 0 || timeout_ <= 0.0)
+  {
+    throw std::logic_error("Stomp 'rollout_workers' parameter for group '" + group_ + "' is invalid");
+  }
+  num_workers_ = num_workers;
+  robot_description_ = ros::names::resolve(robot_description_);
+
+  // the workers only evaluate rollouts so they do not load the filters
+  XmlRpc::XmlRpcValue worker_config = task_config;
+  XmlRpc::XmlRpcValue no_plugins;
+  no_plugins.setSize(0);
+  worker_config["noisy_filters"] = no_plugins;
+  worker_config["update_filters"] = no_plugins;
+  std::string config_xml = worker_config.toXml();
+
+  // creating the shared memory, its name is unique to this process
+  static std::atomic<int> num_pools(0);
+  shared_memory_name_ = "/stomp_rollout_workers_" + std::to_string(getpid()) + "_" + std::to_string(num_pools++);
+  int fd = shm_open(shared_memory_name_.c_str(),O_CREAT | O_EXCL | O_RDWR,0600);
+  if(fd < 0)
+  {
+    throw std::logic_error("Stomp rollout workers of group '" + group_ + "' failed to create the shared memory: " +
+                           strerror(errno));
+  }
+
+  void* memory = MAP_FAILED;
+  if(ftruncate(fd,shared_memory_size_) == 0)
+  {
+    memory = mmap(nullptr,shared_memory_size_,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+  }
+  std::string error = strerror(errno);
+  close(fd);
+
+  if(memory == MAP_FAILED)
+  {
+    shm_unlink(shared_memory_name_.c_str());
+    throw std::logic_error("Stomp rollout workers of group '" + group_ + "' failed to map the shared memory: " + error);
+  }
+  shared_memory_ = memory;
+
+  // the memory is zero filled, only the offsets and the semaphores need to be set
+  header_ = new (shared_memory_) RolloutWorkerHeader();
+  header_->config_offset = align(sizeof(RolloutWorkerHeader));
+  header_->config_size = config_xml.size();
+  header_->scene_offset = align(header_->config_offset + header_->config_size);
+  header_->request_offset = header_->scene_offset;
+  if(header_->scene_offset >= shared_memory_size_)
+  {
+    munmap(shared_memory_,shared_memory_size_);
+    shm_unlink(shared_memory_name_.c_str());
+    throw std::logic_error("Stomp 'rollout_workers/shared_memory_size' parameter for group '" + group_ + "' is too small");
+  }
+  std::memcpy(static_cast<char*>(shared_memory_) + header_->config_offset,config_xml.data(),config_xml.size());
+  sem_init(&header_->jobs_posted,1,0);
+  sem_init(&header_->batch_done,1,0);
+
+  if(!startWorkers())
+  {
+    stopWorkers();
+    munmap(shared_memory_,shared_memory_size_);
+    shm_unlink(shared_memory_name_.c_str());
+    throw std::logic_error("Stomp rollout workers of group '" + group_ + "' could not be started");
+  }
+}
+
+RolloutWorkerPool::~RolloutWorkerPool()
+{
+  stopWorkers();
+  munmap(shared_memory_,shared_memory_size_);
+  shm_unlink(shared_memory_name_.c_str());
+}
+
+bool RolloutWorkerPool::isReady()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(workers_.empty())
+  {
+    return false;
+  }
+
+  bool started = header_->num_ready == workers_.size();
+  if(!workersRunning())
+  {
+    if(started)
+    {
+      // a worker crashed in a previous request
+      stopWorkers();
+      startWorkers();
+    }
+    else
+    {
+      ROS_ERROR("Stomp rollout workers of group '%s' failed to start, the rollouts are evaluated by the planner",
+                group_.c_str());
+      stopWorkers();
+    }
+    return false;
+  }
+
+  return started;
+}
+
+RolloutWorkerPool::RequestConstPtr RolloutWorkerPool::setMotionPlanRequest(
+    const planning_scene::PlanningSceneConstPtr& planning_scene,
+    const moveit_msgs::MotionPlanRequest &req,
+    const stomp_core::StompConfiguration &config)
+{
+  std::shared_ptr<Request> request = std::make_shared<Request>();
+  request->planning_scene = planning_scene;
+  request->scene_version = utils::hashing::hashPlanningScene(planning_scene);
+  request->req = req;
+  request->config = config;
+
+  // written right away so that a request that does not fit is evaluated by the planner
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(!writeRequest(*request))
+  {
+    current_request_.reset();
+    return nullptr;
+  }
+
+  current_request_ = request;
+  return request;
+}
+
+bool RolloutWorkerPool::writeRequest(const Request& request)
+{
+  namespace ser = ros::serialization;
+
+  char* memory = static_cast<char*>(shared_memory_);
+
+  // the scene is only written when its contents change
+  if(request.scene_version != header_->scene_version)
+  {
+    moveit_msgs::PlanningScene scene_msg;
+    request.planning_scene->getPlanningSceneMsg(scene_msg);
+    uint32_t size = ser::serializationLength(scene_msg);
+    if(header_->scene_offset + size > shared_memory_size_)
+    {
+      ROS_ERROR("Stomp rollout workers of group '%s' have no room for a planning scene of %u bytes, increase "
+          "'shared_memory_size'",group_.c_str(),size);
+      header_->scene_version = 0;
+      header_->request_version++;
+      return false;
+    }
+
+    ser::OStream stream(reinterpret_cast<uint8_t*>(memory + header_->scene_offset),size);
+    ser::serialize(stream,scene_msg);
+    header_->scene_size = size;
+    header_->scene_version = request.scene_version;
+  }
+
+  // the request follows the scene
+  uint32_t size = ser::serializationLength(request.req);
+  header_->request_offset = align(header_->scene_offset + header_->scene_size);
+  if(header_->request_offset + size > shared_memory_size_)
+  {
+    ROS_ERROR("Stomp rollout workers of group '%s' have no room for a request of %u bytes, increase "
+        "'shared_memory_size'",group_.c_str(),size);
+    header_->request_size = 0;
+    header_->request_version++;
+    return false;
+  }
+
+  ser::OStream stream(reinterpret_cast<uint8_t*>(memory + header_->request_offset),size);
+  ser::serialize(stream,request.req);
+  header_->request_size = size;
+  header_->stomp_config = request.config;
+  header_->request_version++;
+
+  return true;
+}
+
+bool RolloutWorkerPool::computeNoisyCosts(const RequestConstPtr& request,
+                                          const std::vector<Eigen::MatrixXd>& parameters,
+                                          std::size_t start_timestep,
+                                          std::size_t num_timesteps,
+                                          int iteration_number,
+                                          std::vector<Eigen::VectorXd>& costs,
+                                          bool& validity)
+{
+  validity = true;
+  if(parameters.empty())
+  {
+    return true;
+  }
+
+  // another task may have passed its own request since the last batch of this one
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(current_request_.lock() != request)
+  {
+    if(!writeRequest(*request))
+    {
+      current_request_.reset();
+      return false;
+    }
+    current_request_ = request;
+  }
+
+  // laying out the jobs after the request
+  std::size_t num_dimensions = parameters.front().rows();
+  std::size_t num_parameters = parameters.front().cols();
+  std::size_t job_size = align(sizeof(RolloutJob) + (num_dimensions * num_parameters + num_timesteps) * sizeof(double));
+  std::size_t jobs_offset = align(header_->request_offset + header_->request_size);
+  if(jobs_offset + parameters.size() * job_size > shared_memory_size_)
+  {
+    ROS_ERROR("Stomp rollout workers of group '%s' have no room for %lu rollouts, increase 'shared_memory_size'",
+              group_.c_str(),parameters.size());
+    return false;
+  }
+
+  header_->jobs_offset = jobs_offset;
+  header_->job_size = job_size;
+  header_->num_dimensions = num_dimensions;
+  header_->num_parameters = num_parameters;
+  header_->num_timesteps = num_timesteps;
+  header_->start_timestep = start_timestep;
+  header_->iteration_number = iteration_number;
+
+  char* jobs = static_cast<char*>(shared_memory_) + jobs_offset;
+  for(auto r = 0u; r < parameters.size(); r++)
+  {
+    RolloutJob* job = reinterpret_cast<RolloutJob*>(jobs + r * job_size);
+    job->rollout_number = r;
+    job->valid = 0;
+    Eigen::Map<Eigen::MatrixXd>(reinterpret_cast<double*>(job + 1),num_dimensions,num_parameters) = parameters[r];
+  }
+
+  // posting the jobs, the semaphores order the memory accesses
+  header_->next_job = 0;
+  header_->num_done = 0;
+  header_->num_failed = 0;
+  header_->num_jobs = parameters.size();
+  for(auto r = 0u; r < parameters.size(); r++)
+  {
+    sem_post(&header_->jobs_posted);
+  }
+
+  // waiting for the last job while watching the workers
+  ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(timeout_);
+  while(true)
+  {
+    timespec wake = timeFromNow(WAIT_PERIOD);
+    if(sem_timedwait(&header_->batch_done,&wake) == 0)
+    {
+      break;
+    }
+
+    if(errno == EINTR)
+    {
+      continue;
+    }
+
+    if(!workersRunning())
+    {
+      ROS_ERROR("Stomp rollout worker of group '%s' exited while evaluating rollouts, restarting the workers",
+                group_.c_str());
+      stopWorkers();
+      startWorkers();
+      return false;
+    }
+
+    if(ros::WallTime::now() > deadline)
+    {
+      ROS_ERROR("Stomp rollout workers of group '%s' did not evaluate the rollouts within %f seconds, restarting the "
+          "workers",group_.c_str(),timeout_);
+      stopWorkers();
+      startWorkers();
+      return false;
+    }
+  }
+
+  if(header_->num_failed > 0)
+  {
+    ROS_ERROR("Stomp rollout workers of group '%s' failed to compute the costs of %u rollouts",group_.c_str(),
+              header_->num_failed.load());
+    return false;
+  }
+
+  // reading the costs
+  for(auto r = 0u; r < parameters.size(); r++)
+  {
+    RolloutJob* job = reinterpret_cast<RolloutJob*>(jobs + r * job_size);
+    const double* job_costs = reinterpret_cast<const double*>(job + 1) + num_dimensions * num_parameters;
+    costs[r] = Eigen::Map<const Eigen::VectorXd>(job_costs,num_timesteps);
+    validity &= job->valid != 0;
+  }
+
+  return true;
+}
+
+bool RolloutWorkerPool::startWorkers()
+{
+  header_->num_ready = 0;
+  std::string parent_pid = std::to_string(getpid());
+  std::vector<std::string> args = {executable_,shared_memory_name_,group_,robot_description_,parent_pid};
+  std::vector<char*> argv;
+  for(auto& a : args)
+  {
+    argv.push_back(&a[0]);
+  }
+  argv.push_back(nullptr);
+
+  for(auto i = 0u; i < num_workers_; i++)
+  {
+    pid_t pid;
+    int error = posix_spawn(&pid,executable_.c_str(),nullptr,nullptr,argv.data(),environ);
+    if(error != 0)
+    {
+      ROS_ERROR("Stomp rollout worker '%s' could not be started: %s",executable_.c_str(),strerror(error));
+      return false;
+    }
+    workers_.push_back(pid);
+  }
+
+  ROS_INFO("Stomp started %lu rollout workers for group '%s'",workers_.size(),group_.c_str());
+  return true;
+}
+
+void RolloutWorkerPool::stopWorkers()
+{
+  for(pid_t pid : workers_)
+  {
+    if(pid > 0)
+    {
+      kill(pid,SIGKILL);
+    }
+  }
+
+  for(pid_t pid : workers_)
+  {
+    if(pid > 0)
+    {
+      waitpid(pid,nullptr,0);
+    }
+  }
+  workers_.clear();
+
+  // no process waits on the semaphores anymore, clearing the counts of an interrupted batch
+  sem_destroy(&header_->jobs_posted);
+  sem_destroy(&header_->batch_done);
+  sem_init(&header_->jobs_posted,1,0);
+  sem_init(&header_->batch_done,1,0);
+  header_->num_ready = 0;
+}
+
+bool RolloutWorkerPool::workersRunning()
+{
+  bool running = true;
+  for(pid_t& pid : workers_)
+  {
+    if(pid > 0 && waitpid(pid,nullptr,WNOHANG) == pid)
+    {
+      // reaped, its pid may be reused by another process
+      pid = 0;
+    }
+    running &= pid > 0;
+  }
+  return running;
+}
+
+} /* namespace stomp_moveit */
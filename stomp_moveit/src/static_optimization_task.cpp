@@ -0,0 +1,72 @@
+/**
+ * @file static_optimization_task.cpp
+ * @brief This defines the static pipeline of the plugins built into stomp_moveit
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stomp_moveit/static_optimization_task.h>
+#include <stomp_moveit/cost_functions/collision_check.h>
+#include <stomp_moveit/cost_functions/obstacle_distance_gradient.h>
+#include <stomp_moveit/noise_generators/normal_distribution_sampling.h>
+#include <stomp_moveit/noisy_filters/joint_limits.h>
+#include <stomp_moveit/noisy_filters/multi_trajectory_visualization.h>
+#include <stomp_moveit/update_filters/control_cost_projection.h>
+#include <stomp_moveit/update_filters/polynomial_smoother.h>
+#include <stomp_moveit/update_filters/trajectory_visualization.h>
+#include <stomp_moveit/update_filters/update_logger.h>
+
+#define STOMP_MOVEIT_PLUGIN_NAME(plugin_class, plugin_name) \
+  template <> \
+  struct PluginName<plugin_class> \
+  { \
+    static const char* value() { return plugin_name; } \
+  };
+
+namespace stomp_moveit
+{
+
+// the names declared in the plugin description files
+STOMP_MOVEIT_PLUGIN_NAME(cost_functions::CollisionCheck, "stomp_moveit/CollisionCheck")
+STOMP_MOVEIT_PLUGIN_NAME(cost_functions::ObstacleDistanceGradient, "stomp_moveit/ObstacleDistanceGradient")
+STOMP_MOVEIT_PLUGIN_NAME(noise_generators::NormalDistributionSampling, "stomp_moveit/NormalDistributionSampling")
+STOMP_MOVEIT_PLUGIN_NAME(noisy_filters::JointLimits, "stomp_moveit/JointLimits")
+STOMP_MOVEIT_PLUGIN_NAME(noisy_filters::MultiTrajectoryVisualization, "stomp_moveit/MultiTrajectoryVisualization")
+STOMP_MOVEIT_PLUGIN_NAME(update_filters::ControlCostProjection, "stomp_moveit/ControlCostProjectionMatrix")
+STOMP_MOVEIT_PLUGIN_NAME(update_filters::PolynomialSmoother, "stomp_moveit/PolynomialSmoother")
+STOMP_MOVEIT_PLUGIN_NAME(update_filters::TrajectoryVisualization, "stomp_moveit/TrajectoryVisualization")
+STOMP_MOVEIT_PLUGIN_NAME(update_filters::UpdateLogger, "stomp_moveit/UpdateLogger")
+
+typedef StaticOptimizationTask<
+    PluginList<cost_functions::CollisionCheck,
+               cost_functions::ObstacleDistanceGradient>,
+    PluginList<noise_generators::NormalDistributionSampling>,
+    PluginList<noisy_filters::JointLimits,
+               noisy_filters::MultiTrajectoryVisualization>,
+    PluginList<update_filters::ControlCostProjection,
+               update_filters::PolynomialSmoother,
+               update_filters::TrajectoryVisualization,
+               update_filters::UpdateLogger> > BuiltinOptimizationTask;
+
+std::shared_ptr<StompOptimizationTask> createBuiltinOptimizationTask(moveit::core::RobotModelConstPtr robot_model_ptr,
+                                                                     std::string group_name,
+                                                                     const XmlRpc::XmlRpcValue& config,
+                                                                     bool lazy_plugin_loading)
+{
+  return std::make_shared<BuiltinOptimizationTask>(robot_model_ptr,group_name,config,lazy_plugin_loading);
+}
+
+} /* namespace stomp_moveit */
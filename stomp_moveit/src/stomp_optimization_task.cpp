@@ -23,8 +23,11 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <limits>
+#include <mutex>
 #include <stdexcept>
 #include "stomp_moveit/stomp_optimization_task.h"
+#include <stomp_core/trace.h>
 
 using PluginConfigs = std::vector< std::pair<std::string,XmlRpc::XmlRpcValue> >;
 
@@ -33,6 +36,20 @@ static const std::string NOISY_FILTERS_FIELD = "noisy_filters";
 static const std::string UPDATE_FILTERS_FIELD = "update_filters";
 static const std::string NOISE_GENERATOR_FIELD = "noise_generator";
 
+/**
+ * @brief Names the trace span of a plugin call after the plugin, the name is only built while tracing
+ * @param span    The span
+ * @param plugin  The plugin
+ */
+template <typename PluginPtr>
+static void setSpanName(stomp_core::TraceSpan& span, const PluginPtr& plugin)
+{
+  if(span.isActive())
+  {
+    span.setName(plugin->getName());
+  }
+}
+
 /**
  * @brief Convenience method to load an array of STOMP plugins
  * @param config      The parameter value
@@ -174,25 +191,72 @@ bool loadPlugins(const PluginData plugin_data,
   return true;
 }
 
+/**
+ * @brief Gets the plugin loader of a base class shared by all the tasks in the process, it is created when none exists.
+ * @param base_class  The plugin base class
+ * @return The plugin loader
+ */
+template <typename ClassLoader>
+std::shared_ptr<ClassLoader> getSharedLoader(const std::string& base_class)
+{
+  static std::mutex mutex;
+  static std::weak_ptr<ClassLoader> shared_loader;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<ClassLoader> loader = shared_loader.lock();
+  if(!loader)
+  {
+    loader.reset(new ClassLoader("stomp_moveit",base_class));
+    shared_loader = loader;
+  }
+  return loader;
+}
+
 namespace stomp_moveit
 {
 
 StompOptimizationTask::StompOptimizationTask(
     moveit::core::RobotModelConstPtr robot_model_ptr,
     std::string group_name,
-    const XmlRpc::XmlRpcValue& config):
+    const XmlRpc::XmlRpcValue& config,
+    bool lazy_plugin_loading):
         robot_model_ptr_(robot_model_ptr),
-        group_name_(group_name)
+        group_name_(group_name),
+        config_(config),
+        plugins_loaded_(false),
+        final_cost_(0.0),
+        final_iterations_(0),
+        optimized_cost_(0.0),
+        optimized_valid_(false),
+        optimized_iteration_(-1),
+        lowest_valid_cost_(std::numeric_limits<double>::max())
+{
+  if(!lazy_plugin_loading && !loadPlugins())
+  {
+    throw std::logic_error("plugin not found");
+  }
+}
+
+bool StompOptimizationTask::loadPlugins()
 {
-  // initializing plugin loaders
-  cost_function_loader_.reset(new CostFunctionLoader("stomp_moveit", "stomp_moveit::cost_functions::StompCostFunction"));
-  noise_generator_loader_.reset(new NoiseGeneratorLoader("stomp_moveit","stomp_moveit::noise_generators::StompNoiseGenerator"));
-  noisy_filter_loader_.reset(new NoisyFilterLoader("stomp_moveit", "stomp_moveit::noisy_filters::StompNoisyFilter"));
-  update_filter_loader_.reset(new UpdateFilterLoader("stomp_moveit", "stomp_moveit::update_filters::StompUpdateFilter"));
+  if(plugins_loaded_)
+  {
+    return true;
+  }
+
+  // the loaders parse the plugin descriptions once per process and are not safe to use concurrently
+  static std::mutex loading_mutex;
+  std::lock_guard<std::mutex> lock(loading_mutex);
+
+  // getting the plugin loaders shared by all the groups
+  cost_function_loader_ = getSharedLoader<CostFunctionLoader>("stomp_moveit::cost_functions::StompCostFunction");
+  noise_generator_loader_ = getSharedLoader<NoiseGeneratorLoader>("stomp_moveit::noise_generators::StompNoiseGenerator");
+  noisy_filter_loader_ = getSharedLoader<NoisyFilterLoader>("stomp_moveit::noisy_filters::StompNoisyFilter");
+  update_filter_loader_ = getSharedLoader<UpdateFilterLoader>("stomp_moveit::update_filters::StompUpdateFilter");
 
   // preparing plugin init data
   PluginData plugin_data;
-  plugin_data.config = config;
+  plugin_data.config = config_;
   plugin_data.group_name = group_name_;
   plugin_data.robot_model = robot_model_ptr_;
 
@@ -201,10 +265,10 @@ StompOptimizationTask::StompOptimizationTask(
   plugin_data.plugin_desc = "CostFunction";
   plugin_data.critical = true;
   plugin_data.single_instance = false;
-  if(!loadPlugins(plugin_data,cost_function_loader_,cost_functions_))
+  if(!::loadPlugins(plugin_data,cost_function_loader_,cost_functions_))
   {
-    ROS_ERROR("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name.c_str(),COST_FUNCTIONS_FIELD.c_str());
-    throw std::logic_error("plugin not found");
+    ROS_ERROR("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name_.c_str(),COST_FUNCTIONS_FIELD.c_str());
+    return false;
   }
 
   // loading noise generators
@@ -212,11 +276,11 @@ StompOptimizationTask::StompOptimizationTask(
   plugin_data.plugin_desc = "NoiseGenerator";
   plugin_data.critical = true;
   plugin_data.single_instance = true;
-  if(!loadPlugins(plugin_data, noise_generator_loader_,noise_generators_))
+  if(!::loadPlugins(plugin_data, noise_generator_loader_,noise_generators_))
   {
-    ROS_ERROR("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name.c_str(),
+    ROS_ERROR("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name_.c_str(),
              NOISE_GENERATOR_FIELD.c_str());
-    throw std::logic_error("plugin not found");
+    return false;
   }
 
   // loading noisy filter plugins
@@ -224,9 +288,9 @@ StompOptimizationTask::StompOptimizationTask(
   plugin_data.plugin_desc = "NoisyFilter";
   plugin_data.critical = false;
   plugin_data.single_instance = false;
-  if(!loadPlugins(plugin_data,noisy_filter_loader_,noisy_filters_))
+  if(!::loadPlugins(plugin_data,noisy_filter_loader_,noisy_filters_))
   {
-    ROS_WARN("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name.c_str(),NOISY_FILTERS_FIELD.c_str());
+    ROS_WARN("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name_.c_str(),NOISY_FILTERS_FIELD.c_str());
   }
 
   // loading filter plugins
@@ -234,10 +298,13 @@ StompOptimizationTask::StompOptimizationTask(
   plugin_data.plugin_desc = "UpdateFilter";
   plugin_data.critical = false;
   plugin_data.single_instance = false;
-  if(!loadPlugins(plugin_data,update_filter_loader_,update_filters_))
+  if(!::loadPlugins(plugin_data,update_filter_loader_,update_filters_))
   {
-    ROS_WARN("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name.c_str(),UPDATE_FILTERS_FIELD.c_str());
+    ROS_WARN("StompOptimizationTask/%s failed to load '%s' plugins from yaml",group_name_.c_str(),UPDATE_FILTERS_FIELD.c_str());
   }
+
+  plugins_loaded_ = true;
+  return true;
 }
 
 StompOptimizationTask::~StompOptimizationTask()
@@ -253,6 +320,8 @@ bool StompOptimizationTask::generateNoisyParameters(const Eigen::MatrixXd& param
                                      Eigen::MatrixXd& parameters_noise,
                                      Eigen::MatrixXd& noise)
 {
+  stomp_core::TraceSpan span("","generateNoise","rollout",rollout_number);
+  setSpanName(span,noise_generators_.back());
   return noise_generators_.back()->generateNoise(parameters,start_timestep,num_timesteps,iteration_number,rollout_number,
                                                  parameters_noise,noise);
 }
@@ -273,6 +342,8 @@ bool StompOptimizationTask::computeNoisyCosts(const Eigen::MatrixXd& parameters,
     bool valid;
     auto cf = cost_functions_[i];
 
+    stomp_core::TraceSpan span("","computeCosts","rollout",rollout_number);
+    setSpanName(span,cf);
     if(!cf->computeCosts(parameters,start_timestep,num_timesteps,iteration_number,rollout_number,state_costs,valid))
     {
       return false;
@@ -286,6 +357,27 @@ bool StompOptimizationTask::computeNoisyCosts(const Eigen::MatrixXd& parameters,
   return true;
 }
 
+bool StompOptimizationTask::supportsNoisyCostsBatch() const
+{
+  return rollout_workers_ != nullptr;
+}
+
+bool StompOptimizationTask::computeNoisyCostsBatch(const std::vector<Eigen::MatrixXd>& parameters,
+                                                   std::size_t start_timestep,
+                                                   std::size_t num_timesteps,
+                                                   int iteration_number,
+                                                   std::vector<Eigen::VectorXd>& costs,
+                                                   bool& validity)
+{
+  if(rollout_workers_request_ && rollout_workers_->isReady())
+  {
+    return rollout_workers_->computeNoisyCosts(rollout_workers_request_,parameters,start_timestep,num_timesteps,
+                                               iteration_number,costs,validity);
+  }
+
+  return stomp_core::Task::computeNoisyCostsBatch(parameters,start_timestep,num_timesteps,iteration_number,costs,validity);
+}
+
 bool StompOptimizationTask::computeCosts(const Eigen::MatrixXd& parameters,
                                          std::size_t start_timestep,
                                          std::size_t num_timesteps,
@@ -301,6 +393,8 @@ bool StompOptimizationTask::computeCosts(const Eigen::MatrixXd& parameters,
     bool valid;
     auto cf = cost_functions_[i];
 
+    stomp_core::TraceSpan span("","computeCosts");
+    setSpanName(span,cf);
     if(!cf->computeCosts(parameters,start_timestep,num_timesteps,iteration_number,cf->getOptimizedIndex(),state_costs,valid))
     {
       return false;
@@ -311,16 +405,40 @@ bool StompOptimizationTask::computeCosts(const Eigen::MatrixXd& parameters,
     cost_matrix.col(i) = state_costs * cf->getWeight();
   }
   costs = cost_matrix.rowwise().sum();
+  setOptimizedCosts(parameters,iteration_number,costs,validity);
   return true;
 }
 
+void StompOptimizationTask::setOptimizedCosts(const Eigen::MatrixXd& parameters,int iteration_number,
+                                              const Eigen::VectorXd& costs,bool validity)
+{
+  // kept for postIteration(), the parameters it receives may have been reverted to those of a previous iteration
+  optimized_parameters_ = parameters;
+  optimized_cost_ = costs.sum();
+  optimized_valid_ = validity;
+  optimized_iteration_ = iteration_number;
+}
+
 bool StompOptimizationTask::setMotionPlanRequest(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                         const moveit_msgs::MotionPlanRequest &req,
                                         const stomp_core::StompConfiguration &config,
                                         moveit_msgs::MoveItErrorCodes& error_code)
 {
+  if(!loadPlugins())
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+    return false;
+  }
+
+  optimized_valid_ = false;
+  optimized_iteration_ = -1;
+  lowest_valid_cost_ = std::numeric_limits<double>::max();
+  rollout_workers_request_.reset();
+
   for(auto p: noise_generators_)
   {
+    stomp_core::TraceSpan span("","setMotionPlanRequest");
+    setSpanName(span,p);
     if(!p->setMotionPlanRequest(planning_scene,req,config,error_code))
     {
       ROS_ERROR("Failed to set Plan Request on noise generator %s",p->getName().c_str());
@@ -330,6 +448,8 @@ bool StompOptimizationTask::setMotionPlanRequest(const planning_scene::PlanningS
 
   for(auto p : cost_functions_)
   {
+    stomp_core::TraceSpan span("","setMotionPlanRequest");
+    setSpanName(span,p);
     if(!p->setMotionPlanRequest(planning_scene,req,config,error_code))
     {
       ROS_ERROR("Failed to set Plan Request on cost function %s",p->getName().c_str());
@@ -339,6 +459,8 @@ bool StompOptimizationTask::setMotionPlanRequest(const planning_scene::PlanningS
 
   for(auto p: noisy_filters_)
   {
+    stomp_core::TraceSpan span("","setMotionPlanRequest");
+    setSpanName(span,p);
     if(!p->setMotionPlanRequest(planning_scene,req,config,error_code))
     {
       ROS_ERROR("Failed to set Plan Request on noisy filter %s",p->getName().c_str());
@@ -348,6 +470,8 @@ bool StompOptimizationTask::setMotionPlanRequest(const planning_scene::PlanningS
 
   for(auto p: update_filters_)
   {
+    stomp_core::TraceSpan span("","setMotionPlanRequest");
+    setSpanName(span,p);
     if(!p->setMotionPlanRequest(planning_scene,req,config,error_code))
     {
       ROS_ERROR("Failed to set Plan Request on update filter %s",p->getName().c_str());
@@ -355,6 +479,11 @@ bool StompOptimizationTask::setMotionPlanRequest(const planning_scene::PlanningS
     }
   }
 
+  if(rollout_workers_)
+  {
+    rollout_workers_request_ = rollout_workers_->setMotionPlanRequest(planning_scene,req,config);
+  }
+
   return true;
 }
 
@@ -368,6 +497,8 @@ bool StompOptimizationTask::filterNoisyParameters(std::size_t start_timestep,
   bool temp;
   for(auto& f: noisy_filters_)
   {
+    stomp_core::TraceSpan span("","filterNoisyParameters","rollout",rollout_number);
+    setSpanName(span,f);
     if(f->filter(start_timestep,num_timesteps,iteration_number,rollout_number,parameters,temp))
     {
       filtered |= temp;
@@ -390,6 +521,8 @@ bool StompOptimizationTask::filterParameterUpdates(std::size_t start_timestep,
   bool temp;
   for(auto& f: update_filters_)
   {
+    stomp_core::TraceSpan span("","filterParameterUpdates");
+    setSpanName(span,f);
     if(f->filter(start_timestep,num_timesteps,iteration_number,parameters,updates,temp))
     {
       filtered |= temp;
@@ -424,10 +557,21 @@ void StompOptimizationTask::postIteration(std::size_t start_timestep,
   {
     p->postIteration(start_timestep,num_timesteps,iteration_number,cost,parameters);
   }
+
+  // the cost received is the lowest of the optimization, which may belong to earlier parameters
+  if(improvement_callback_ && optimized_valid_ && optimized_iteration_ == iteration_number &&
+      optimized_cost_ < lowest_valid_cost_)
+  {
+    lowest_valid_cost_ = optimized_cost_;
+    improvement_callback_(iteration_number,optimized_cost_,optimized_parameters_);
+  }
 }
 
 void StompOptimizationTask::done(bool success,int total_iterations,double final_cost,const Eigen::MatrixXd& parameters)
 {
+  final_cost_ = final_cost;
+  final_iterations_ = total_iterations;
+
   for(auto p : noise_generators_)
   {
     p->done(success,total_iterations,final_cost,parameters);
@@ -450,4 +594,33 @@ void StompOptimizationTask::done(bool success,int total_iterations,double final_
   }
 }
 
+void StompOptimizationTask::setImprovementCallback(ImprovementCallback callback)
+{
+  improvement_callback_ = callback;
+}
+
+void StompOptimizationTask::setRolloutWorkers(RolloutWorkerPoolPtr workers)
+{
+  rollout_workers_ = workers;
+  rollout_workers_request_.reset();
+}
+
+void StompOptimizationTask::getValidityCertificates(std::vector<cost_functions::ValidityCertificate>& certificates) const
+{
+  for(const auto& cf : cost_functions_)
+  {
+    cf->getValidityCertificates(certificates);
+  }
+}
+
+double StompOptimizationTask::getFinalCost() const
+{
+  return final_cost_;
+}
+
+int StompOptimizationTask::getFinalIterations() const
+{
+  return final_iterations_;
+}
+
 } /* namespace stomp_moveit */
@@ -26,11 +26,17 @@
 #include <ros/ros.h>
 #include <moveit/robot_state/conversions.h>
 #include <stomp_moveit/stomp_planner.h>
+#include <stomp_moveit/static_optimization_task.h>
 #include <class_loader/class_loader.hpp>
 #include <stomp_core/utils.h>
+#include <stomp_core/trace.h>
 #include <moveit/trajectory_processing/iterative_time_parameterization.h>
+#include <moveit/kinematic_constraints/utils.h>
 #include <stomp_moveit/utils/kinematics.h>
 #include <stomp_moveit/utils/polynomial.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 static const std::string DEBUG_NS = "stomp_planner";
 static const std::string DESCRIPTION = "STOMP";
@@ -38,6 +44,13 @@ static const double TIMEOUT_INTERVAL = 0.5;
 static int const IK_ATTEMPTS = 4;
 static int const IK_TIMEOUT = 0.005;
 const static double MAX_START_DISTANCE_THRESH = 0.5;
+static const double DEFAULT_SECONDS_PER_TIMESTEP = 0.1;
+static const double DEFAULT_LIBRARY_MAX_DISTANCE = MAX_START_DISTANCE_THRESH;
+static const int DEFAULT_NUM_VALIDATION_THREADS = 1;
+static const std::size_t MIN_WAYPOINTS_PER_VALIDATION_THREAD = 8;
+static const double DEFAULT_REFINEMENT_TIME = 1.0;
+static const double WARM_UP_PLANNING_TIME = 5.0;
+static const double WARM_UP_JOINT_RANGE_FRACTION = 0.1;
 
 /**
  * @brief Parses a XmlRpcValue and populates a StompComfiguration structure.
@@ -59,6 +72,7 @@ bool parseConfig(XmlRpc::XmlRpcValue config,const moveit::core::JointModelGroup*
   stomp_config.max_rollouts = 100;
   stomp_config.num_rollouts = 10;
   stomp_config.exponentiated_cost_sensitivity = 10.0;
+  stomp_config.num_control_points = 0;
 
   // Load optional config parameters if they exist
   if (config.hasMember("control_cost_weight"))
@@ -88,6 +102,9 @@ bool parseConfig(XmlRpc::XmlRpcValue config,const moveit::core::JointModelGroup*
   if (config.hasMember("exponentiated_cost_sensitivity"))
     stomp_config.exponentiated_cost_sensitivity = static_cast<int>(config["exponentiated_cost_sensitivity"]);
 
+  if (config.hasMember("num_control_points"))
+    stomp_config.num_control_points = static_cast<int>(config["num_control_points"]);
+
   // getting number of joints
   stomp_config.num_dimensions = group->getActiveJointModels().size();
   if(stomp_config.num_dimensions == 0)
@@ -106,6 +123,17 @@ StompPlanner::StompPlanner(const std::string& group,const XmlRpc::XmlRpcValue& c
                            const moveit::core::RobotModelConstPtr& model):
     PlanningContext(DESCRIPTION,group),
     config_(config),
+    adaptive_timesteps_(false),
+    min_num_timesteps_(0),
+    max_num_timesteps_(0),
+    seconds_per_timestep_(DEFAULT_SECONDS_PER_TIMESTEP),
+    library_max_distance_(DEFAULT_LIBRARY_MAX_DISTANCE),
+    num_validation_threads_(DEFAULT_NUM_VALIDATION_THREADS),
+    stream_solutions_(false),
+    solve_count_(0),
+    refinement_iterations_(0),
+    refinement_time_(DEFAULT_REFINEMENT_TIME),
+    terminated_(false),
     robot_model_(model),
     ik_solver_(new utils::kinematics::IKSolver(model,group)),
     ph_(new ros::NodeHandle("~"))
@@ -115,6 +143,7 @@ StompPlanner::StompPlanner(const std::string& group,const XmlRpc::XmlRpcValue& c
 
 StompPlanner::~StompPlanner()
 {
+  stopRefinement();
 }
 
 void StompPlanner::setup()
@@ -130,7 +159,23 @@ void StompPlanner::setup()
     // creating tasks
     XmlRpc::XmlRpcValue task_config;
     task_config = config_["task"];
-    task_.reset(new StompOptimizationTask(robot_model_,group_,task_config));
+    bool lazy_plugin_loading = config_.hasMember("lazy_plugin_loading") && static_cast<bool>(config_["lazy_plugin_loading"]);
+    std::string plugin_pipeline = config_.hasMember("plugin_pipeline") ?
+        static_cast<std::string>(config_["plugin_pipeline"]) : std::string("pluginlib");
+    if(plugin_pipeline == "static")
+    {
+      task_ = createBuiltinOptimizationTask(robot_model_,group_,task_config,lazy_plugin_loading);
+    }
+    else if(plugin_pipeline == "pluginlib")
+    {
+      task_.reset(new StompOptimizationTask(robot_model_,group_,task_config,lazy_plugin_loading));
+    }
+    else
+    {
+      std::string msg = "Stomp 'plugin_pipeline' parameter for group '" + group_ + "' must be 'static' or 'pluginlib'";
+      ROS_ERROR("%s",msg.c_str());
+      throw std::logic_error(msg);
+    }
 
     if(!robot_model_->hasJointModelGroup(group_))
     {
@@ -147,6 +192,87 @@ void StompPlanner::setup()
       throw std::logic_error(msg);
     }
 
+    // parsing adaptive timesteps parameters
+    XmlRpc::XmlRpcValue opt_config = config_["optimization"];
+    adaptive_timesteps_ = opt_config.hasMember("adaptive_timesteps");
+    if(adaptive_timesteps_)
+    {
+      XmlRpc::XmlRpcValue adaptive_config = opt_config["adaptive_timesteps"];
+      min_num_timesteps_ = stomp_config_.num_timesteps;
+      max_num_timesteps_ = stomp_config_.num_timesteps;
+      if(adaptive_config.hasMember("min_num_timesteps"))
+        min_num_timesteps_ = static_cast<int>(adaptive_config["min_num_timesteps"]);
+
+      if(adaptive_config.hasMember("max_num_timesteps"))
+        max_num_timesteps_ = static_cast<int>(adaptive_config["max_num_timesteps"]);
+
+      if(adaptive_config.hasMember("seconds_per_timestep"))
+        seconds_per_timestep_ = static_cast<double>(adaptive_config["seconds_per_timestep"]);
+
+      // the control points must remain fewer than the timesteps
+      int lowest_num_timesteps = std::max(stomp_config_.num_control_points + 1,3);
+      if(min_num_timesteps_ < lowest_num_timesteps)
+      {
+        ROS_WARN("%s 'min_num_timesteps' must be at least %i, using that value",getName().c_str(),lowest_num_timesteps);
+        min_num_timesteps_ = lowest_num_timesteps;
+      }
+
+      if(max_num_timesteps_ < min_num_timesteps_ || seconds_per_timestep_ <= 0.0)
+      {
+        std::string msg = "Stomp 'adaptive_timesteps' parameter for group '" + group_ + "' is invalid";
+        ROS_ERROR("%s", msg.c_str());
+        throw std::logic_error(msg);
+      }
+    }
+
+    // parsing validation parameters
+    if(config_.hasMember("num_validation_threads"))
+    {
+      num_validation_threads_ = static_cast<int>(config_["num_validation_threads"]);
+      if(num_validation_threads_ < 1)
+      {
+        ROS_WARN("%s 'num_validation_threads' must be at least 1, validating on a single thread",getName().c_str());
+        num_validation_threads_ = 1;
+      }
+    }
+
+    // streaming solutions
+    if(config_.hasMember("stream_solutions"))
+    {
+      setSolutionStreaming(static_cast<bool>(config_["stream_solutions"]));
+    }
+
+    // parsing background refinement parameters
+    if(config_.hasMember("background_refinement"))
+    {
+      XmlRpc::XmlRpcValue refinement_config = config_["background_refinement"];
+      refinement_iterations_ = static_cast<int>(refinement_config["num_iterations"]);
+      if(refinement_config.hasMember("max_time"))
+        refinement_time_ = static_cast<double>(refinement_config["max_time"]);
+
+      if(refinement_iterations_ < 0 || refinement_time_ <= 0.0)
+      {
+        std::string msg = "Stomp 'background_refinement' parameter for group '" + group_ + "' is invalid";
+        ROS_ERROR("%s", msg.c_str());
+        throw std::logic_error(msg);
+      }
+    }
+
+    // parsing the trajectory library seeding parameters, the library itself is shared by the planner manager
+    if(config_.hasMember("trajectory_library"))
+    {
+      XmlRpc::XmlRpcValue library_config = config_["trajectory_library"];
+      if(library_config.hasMember("max_distance"))
+        library_max_distance_ = static_cast<double>(library_config["max_distance"]);
+
+      if(library_max_distance_ <= 0.0)
+      {
+        std::string msg = "Stomp 'trajectory_library' parameter for group '" + group_ + "' is invalid";
+        ROS_ERROR("%s", msg.c_str());
+        throw std::logic_error(msg);
+      }
+    }
+
     stomp_.reset(new stomp_core::Stomp(stomp_config_,task_));
   }
   catch(XmlRpc::XmlRpcException& e)
@@ -184,18 +310,33 @@ bool StompPlanner::solve(planning_interface::MotionPlanDetailedResponse &res)
 
   ros::WallTime start_time = ros::WallTime::now();
   bool success = false;
+  stopRefinement();
+  solve_count_++;
+  stomp_core::TraceSpan span("StompPlanner::solve","planner","solve_id",solve_count_);
+
+  // recorded when returning, as a failure unless marked otherwise
+  PlanningStatistics::Recorder recorder(statistics_,group_,profile_);
+  recorder.startPhase(PlanningStatistics::SETUP);
 
   trajectory_msgs::JointTrajectory trajectory;
   Eigen::MatrixXd parameters;
   bool planning_success;
 
-  // local stomp config copy
+  // local stomp config copy, the polishing iterations are left to the background refinement
   auto config_copy = stomp_config_;
+  if(refinement_iterations_ > 0)
+  {
+    config_copy.num_iterations_after_valid = 0;
+  }
 
   // look for seed trajectory
   Eigen::MatrixXd initial_parameters;
   bool use_seed = getSeedParameters(initial_parameters);
-
+  bool library_seed = false;
+  if(!use_seed && trajectory_library_)
+  {
+    library_seed = use_seed = getLibrarySeedParameters(initial_parameters);
+  }
 
   // create timeout timer
   ros::WallDuration allowed_time(request_.allowed_planning_time);
@@ -217,7 +358,7 @@ bool StompPlanner::solve(planning_interface::MotionPlanDetailedResponse &res)
 
   if (use_seed)
   {
-    ROS_INFO("%s Seeding trajectory from MotionPlanRequest",getName().c_str());
+    ROS_INFO("%s Seeding trajectory from %s",getName().c_str(),library_seed ? "trajectory library" : "MotionPlanRequest");
 
     // updating time step in stomp configuraion
     config_copy.num_timesteps = initial_parameters.cols();
@@ -230,6 +371,8 @@ bool StompPlanner::solve(planning_interface::MotionPlanDetailedResponse &res)
     }
 
     stomp_->setConfig(config_copy);
+    cancelIfTerminated();
+    recorder.startPhase(PlanningStatistics::OPTIMIZATION);
     planning_success = stomp_->solve(initial_parameters, parameters);
   }
   else
@@ -243,6 +386,9 @@ bool StompPlanner::solve(planning_interface::MotionPlanDetailedResponse &res)
       return false;
     }
 
+    // sizing the trajectory to the motion
+    config_copy.num_timesteps = computeNumTimesteps(start,goal);
+
     // setting up up optimization task
     if(!task_->setMotionPlanRequest(planning_scene_,request_, config_copy,res.error_code_))
     {
@@ -251,15 +397,19 @@ bool StompPlanner::solve(planning_interface::MotionPlanDetailedResponse &res)
     }
 
     stomp_->setConfig(config_copy);
+    cancelIfTerminated();
+    recorder.startPhase(PlanningStatistics::OPTIMIZATION);
     planning_success = stomp_->solve(start,goal,parameters);
   }
 
   // stopping timer
   timeout_timer.stop();
+  recorder.setIterations(task_->getFinalIterations());
 
   // Handle results
   if(planning_success)
   {
+    recorder.startPhase(PlanningStatistics::TIME_PARAMETERIZATION);
     if(!parametersToJointTrajectory(parameters,trajectory))
     {
       res.error_code_.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
@@ -280,12 +430,28 @@ bool StompPlanner::solve(planning_interface::MotionPlanDetailedResponse &res)
   }
 
   // checking against planning scene
-  if(planning_scene_ && !planning_scene_->isPathValid(*res.trajectory_.back(),group_,true))
+  recorder.startPhase(PlanningStatistics::VALIDATION);
+  bool valid = !planning_scene_ || isTrajectoryValid(planning_scene_,parameters,*res.trajectory_.back());
+  recorder.endPhase();
+  recorder.setSuccess(valid);
+  if(!valid)
   {
     res.error_code_.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
     success = false;
     ROS_ERROR_STREAM("STOMP Trajectory is in collision");
   }
+  else
+  {
+    if(trajectory_library_)
+    {
+      trajectory_library_->add(parameters,task_->getFinalCost());
+    }
+
+    if(refinement_iterations_ > 0)
+    {
+      startRefinement(parameters,config_copy);
+    }
+  }
 
   ros::WallDuration wd = ros::WallTime::now() - start_time;
   res.processing_time_[0] = ros::Duration(wd.sec, wd.nsec).toSec();
@@ -294,17 +460,290 @@ bool StompPlanner::solve(planning_interface::MotionPlanDetailedResponse &res)
   return true;
 }
 
-bool StompPlanner::getSeedParameters(Eigen::MatrixXd& parameters) const
+bool StompPlanner::warmUp()
 {
-  using namespace utils::kinematics;
-  using namespace utils::polynomial;
+  ros::WallTime start_time = ros::WallTime::now();
+  const moveit::core::JointModelGroup* joint_group = robot_model_->getJointModelGroup(group_);
+
+  // a synthetic request that moves every joint a fraction of its range away from the default state
+  planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(robot_model_));
+  moveit::core::RobotState start_state(robot_model_);
+  start_state.setToDefaultValues();
+  start_state.update();
+  moveit::core::RobotState goal_state(start_state);
+  for(const auto* joint : joint_group->getActiveJointModels())
+  {
+    const moveit::core::VariableBounds& bounds = joint->getVariableBounds()[0];
+    double position = start_state.getVariablePosition(joint->getFirstVariableIndex());
+    double range = bounds.position_bounded_ ? bounds.max_position_ - bounds.min_position_ : 1.0;
+    goal_state.setVariablePosition(joint->getFirstVariableIndex(),position + WARM_UP_JOINT_RANGE_FRACTION * range);
+  }
+  goal_state.enforceBounds(joint_group);
+  goal_state.update();
+
+  moveit_msgs::MotionPlanRequest req;
+  req.group_name = group_;
+  req.allowed_planning_time = WARM_UP_PLANNING_TIME;
+  moveit::core::robotStateToRobotStateMsg(start_state,req.start_state);
+  req.goal_constraints.push_back(kinematic_constraints::constructGoalConstraints(goal_state,joint_group));
+
+  // computing the matrices of every adaptive trajectory size, the optimizer and plugins keep them for later requests
+  moveit_msgs::MoveItErrorCodes error_code;
+  if(adaptive_timesteps_)
+  {
+    auto config = stomp_config_;
+    for(int t = min_num_timesteps_; t <= max_num_timesteps_; t++)
+    {
+      config.num_timesteps = t;
+      task_->setMotionPlanRequest(scene,req,config,error_code);
+      stomp_->setConfig(config);
+    }
+  }
 
-  auto within_tolerance = [&](const Eigen::VectorXd& a, const Eigen::VectorXd& b, double tol) -> bool
+  // running the IK solver once
+  Eigen::VectorXd start, solution;
+  start_state.copyJointGroupPositions(joint_group,start);
+  ik_solver_->setKinematicState(start_state);
+  ik_solver_->solve(start,start_state.getGlobalLinkTransform(joint_group->getLinkModelNames().back()),solution);
+
+  // solving without the side effects meant for real requests
+  utils::TrajectoryLibraryPtr library = trajectory_library_;
+  PlanningStatisticsPtr statistics = statistics_;
+  int refinement_iterations = refinement_iterations_;
+  bool stream_solutions = stream_solutions_;
+  trajectory_library_.reset();
+  statistics_.reset();
+  refinement_iterations_ = 0;
+  if(stream_solutions)
   {
-    double dist = (a - b).cwiseAbs().sum();
-    return dist <= tol;
-  };
+    task_->setImprovementCallback(StompOptimizationTask::ImprovementCallback());
+  }
+
+  clear();
+  setPlanningScene(scene);
+  setMotionPlanRequest(req);
+  planning_interface::MotionPlanDetailedResponse res;
+  bool success = solve(res) && res.error_code_.val == moveit_msgs::MoveItErrorCodes::SUCCESS;
+  clear();
+
+  trajectory_library_ = library;
+  statistics_ = statistics;
+  refinement_iterations_ = refinement_iterations;
+  setSolutionStreaming(stream_solutions,solution_callback_);
+  solve_count_ = 0;
+
+  ROS_INFO("%s warm up for group '%s' took %f seconds",getName().c_str(),group_.c_str(),
+           (ros::WallTime::now() - start_time).toSec());
+  ROS_WARN_COND(!success,"%s warm up failed to solve the synthetic request for group '%s'",getName().c_str(),group_.c_str());
+
+  return success;
+}
+
+bool StompPlanner::getLibrarySeedParameters(Eigen::MatrixXd& parameters)
+{
+  Eigen::VectorXd start, goal;
+  if(!getStartAndGoal(start,goal))
+  {
+    return false;
+  }
+
+  if(!trajectory_library_->findNearest(start,goal,library_max_distance_,parameters))
+  {
+    ROS_DEBUG("%s Found no library trajectory near the requested start and goal",getName().c_str());
+    return false;
+  }
+
+  return fitSeedToRequest(parameters);
+}
+
+void StompPlanner::setTrajectoryLibrary(utils::TrajectoryLibraryPtr library)
+{
+  trajectory_library_ = library;
+}
+
+utils::TrajectoryLibraryPtr StompPlanner::getTrajectoryLibrary() const
+{
+  return trajectory_library_;
+}
+
+void StompPlanner::setRolloutWorkers(RolloutWorkerPoolPtr workers)
+{
+  task_->setRolloutWorkers(workers);
+}
+
+void StompPlanner::setPlanningStatistics(PlanningStatisticsPtr statistics, const std::string& profile)
+{
+  statistics_ = statistics;
+  profile_ = profile;
+}
+
+void StompPlanner::setSolutionStreaming(bool enable, SolutionCallback callback)
+{
+  stream_solutions_ = enable;
+  solution_callback_ = callback;
+  if(stream_solutions_)
+  {
+    task_->setImprovementCallback(std::bind(&StompPlanner::streamSolution,this,std::placeholders::_1,
+                                            std::placeholders::_2,std::placeholders::_3));
+  }
+  else
+  {
+    task_->setImprovementCallback(StompOptimizationTask::ImprovementCallback());
+  }
+}
+
+bool StompPlanner::getLatestSolution(StreamedSolution& solution)
+{
+  if(!solution_buffer_.update())
+  {
+    return false;
+  }
 
+  solution = solution_buffer_.front();
+  return true;
+}
+
+void StompPlanner::streamSolution(int iteration, double cost, const Eigen::MatrixXd& parameters)
+{
+  StreamedSolution& solution = solution_buffer_.back();
+  solution.solve_id = solve_count_;
+  solution.iteration = iteration;
+  solution.cost = cost;
+  solution.parameters = parameters;
+
+  if(solution_callback_)
+  {
+    solution_callback_(solution);
+  }
+  solution_buffer_.publish();
+}
+
+void StompPlanner::setRefinementCallback(RefinementCallback callback)
+{
+  refinement_callback_ = callback;
+}
+
+void StompPlanner::startRefinement(const Eigen::MatrixXd& parameters, const stomp_core::StompConfiguration& config)
+{
+  // configuring here so that a cancellation issued before the thread starts optimizing is not reset
+  auto refinement_config = config;
+  refinement_config.num_timesteps = parameters.cols();
+  refinement_config.num_iterations = refinement_iterations_;
+  refinement_config.num_iterations_after_valid = refinement_iterations_;
+  stomp_->setConfig(refinement_config);
+
+  // the task releases the request state when solve() is done, the refinement sets it up again from these copies
+  refinement_thread_ = std::thread(&StompPlanner::refine,this,parameters,task_->getFinalCost(),solve_count_,
+                                   planning_scene_,request_,refinement_config);
+}
+
+void StompPlanner::refine(Eigen::MatrixXd parameters, double initial_cost, unsigned long solve_id,
+                          planning_scene::PlanningSceneConstPtr scene, moveit_msgs::MotionPlanRequest request,
+                          stomp_core::StompConfiguration config)
+{
+  stomp_core::TraceSpan span("StompPlanner::refine","planner","solve_id",solve_id);
+  moveit_msgs::MoveItErrorCodes error_code;
+  if(!task_->setMotionPlanRequest(scene,request,config,error_code))
+  {
+    ROS_ERROR("%s background refinement failed to set the motion plan request",getName().c_str());
+    return;
+  }
+
+  ros::WallTimer timeout_timer = ph_->createWallTimer(ros::WallDuration(refinement_time_),
+                                                      [this](const ros::WallTimerEvent& evnt)
+  {
+    stomp_->cancel();
+  },true);
+
+  Eigen::MatrixXd refined_parameters;
+  bool refined = stomp_->solve(parameters,refined_parameters);
+  timeout_timer.stop();
+
+  double cost = task_->getFinalCost();
+  if(!refined)
+  {
+    ROS_WARN("%s background refinement did not find a valid solution",getName().c_str());
+    return;
+  }
+
+  if(cost >= initial_cost)
+  {
+    ROS_INFO("%s background refinement did not lower the cost %f, refined cost %f",getName().c_str(),initial_cost,cost);
+    return;
+  }
+
+  trajectory_msgs::JointTrajectory trajectory_msg;
+  if(!parametersToJointTrajectory(refined_parameters,trajectory_msg))
+  {
+    return;
+  }
+
+  moveit::core::RobotState robot_state(robot_model_);
+  moveit::core::robotStateMsgToRobotState(request.start_state,robot_state);
+  robot_trajectory::RobotTrajectoryPtr trajectory(new robot_trajectory::RobotTrajectory(robot_model_,group_));
+  trajectory->setRobotTrajectoryMsg(robot_state,trajectory_msg);
+  if(scene && !isTrajectoryValid(scene,refined_parameters,*trajectory))
+  {
+    ROS_DEBUG("%s background refinement produced an invalid trajectory",getName().c_str());
+    return;
+  }
+
+  ROS_INFO("%s background refinement lowered the cost from %f to %f",getName().c_str(),initial_cost,cost);
+  if(trajectory_library_)
+  {
+    trajectory_library_->add(refined_parameters,cost);
+  }
+
+  if(refinement_callback_)
+  {
+    refinement_callback_(solve_id,trajectory,cost);
+  }
+}
+
+void StompPlanner::stopRefinement()
+{
+  if(refinement_thread_.joinable())
+  {
+    stomp_->cancel();
+    refinement_thread_.join();
+  }
+}
+
+int StompPlanner::computeNumTimesteps(const Eigen::VectorXd& start, const Eigen::VectorXd& goal) const
+{
+  if(!adaptive_timesteps_)
+  {
+    return stomp_config_.num_timesteps;
+  }
+
+  double velocity_scaling = 1.0;
+  if(request_.max_velocity_scaling_factor > 0.0 && request_.max_velocity_scaling_factor <= 1.0)
+  {
+    velocity_scaling = request_.max_velocity_scaling_factor;
+  }
+
+  // time needed by the slowest joint at its maximum velocity
+  const std::vector<const moveit::core::JointModel*>& joint_models = robot_model_->getJointModelGroup(group_)->getActiveJointModels();
+  double duration = 0.0;
+  for(std::size_t j = 0; j < joint_models.size(); j++)
+  {
+    const moveit::core::VariableBounds& bounds = joint_models[j]->getVariableBounds()[0];
+    double distance = std::abs(goal(j) - start(j));
+    if(bounds.velocity_bounded_ && bounds.max_velocity_ > 0.0)
+    {
+      duration = std::max(duration,distance/(bounds.max_velocity_ * velocity_scaling));
+    }
+  }
+
+  int num_timesteps = static_cast<int>(std::ceil(duration/seconds_per_timestep_)) + 1;
+  num_timesteps = std::min(std::max(num_timesteps,min_num_timesteps_),max_num_timesteps_);
+  ROS_DEBUG("%s using %i timesteps for a motion of %f seconds",getName().c_str(),num_timesteps,duration);
+
+  return num_timesteps;
+}
+
+bool StompPlanner::getSeedParameters(Eigen::MatrixXd& parameters) const
+{
   trajectory_msgs::JointTrajectory traj;
   if(!extractSeedTrajectory(request_,traj))
   {
@@ -318,6 +757,20 @@ bool StompPlanner::getSeedParameters(Eigen::MatrixXd& parameters) const
     return false;
   }
 
+  return fitSeedToRequest(parameters);
+}
+
+bool StompPlanner::fitSeedToRequest(Eigen::MatrixXd& parameters) const
+{
+  using namespace utils::kinematics;
+  using namespace utils::polynomial;
+
+  auto within_tolerance = [&](const Eigen::VectorXd& a, const Eigen::VectorXd& b, double tol) -> bool
+  {
+    double dist = (a - b).cwiseAbs().sum();
+    return dist <= tol;
+  };
+
   if(parameters.cols()<= 2)
   {
     ROS_ERROR("%s Found less than 3 points in seed trajectory",getName().c_str());
@@ -452,6 +905,92 @@ bool StompPlanner::getSeedParameters(Eigen::MatrixXd& parameters) const
   return true;
 }
 
+bool StompPlanner::isTrajectoryValid(const planning_scene::PlanningSceneConstPtr& scene,
+                                     const Eigen::MatrixXd& parameters,
+                                     const robot_trajectory::RobotTrajectory& trajectory) const
+{
+  stomp_core::TraceSpan span("StompPlanner::isTrajectoryValid","planner");
+
+  // only the certificates for this scene and trajectory size apply
+  std::vector<cost_functions::ValidityCertificate> certificates;
+  task_->getValidityCertificates(certificates);
+  certificates.erase(std::remove_if(certificates.begin(),certificates.end(),
+                                    [&](const cost_functions::ValidityCertificate& c)
+  {
+    return c.planning_scene != scene || c.waypoints.rows() != parameters.rows() ||
+        c.waypoints.cols() != parameters.cols();
+  }),certificates.end());
+
+  // collecting the checks, certified waypoints only need the feasibility check
+  struct WaypointCheck
+  {
+    std::size_t index;
+    bool check_collision;
+  };
+
+  bool check_feasibility = static_cast<bool>(scene->getStateFeasibilityPredicate());
+  std::vector<WaypointCheck> checks;
+  checks.reserve(trajectory.getWayPointCount());
+  for(std::size_t t = 0; t < trajectory.getWayPointCount(); t++)
+  {
+    bool certified = t < static_cast<std::size_t>(parameters.cols()) &&
+        std::any_of(certificates.begin(),certificates.end(),[&](const cost_functions::ValidityCertificate& c)
+    {
+      return c.waypoints.col(t) == parameters.col(t);
+    });
+
+    if(!certified || check_feasibility)
+    {
+      checks.push_back(WaypointCheck{t,!certified});
+    }
+  }
+
+  ROS_DEBUG("%s checking %lu waypoints out of %lu, the rest were certified",getName().c_str(),
+            static_cast<unsigned long>(checks.size()),static_cast<unsigned long>(trajectory.getWayPointCount()));
+  if(checks.empty())
+  {
+    return true;
+  }
+
+  // each worker checks the next pending waypoint on its own state and all stop at the first invalid one
+  std::atomic<bool> valid(true);
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]()
+  {
+    stomp_core::TraceSpan worker_span("validation worker","planner");
+    moveit::core::RobotState state(trajectory.getWayPoint(0));
+    std::size_t i;
+    while(valid && (i = next++) < checks.size())
+    {
+      const WaypointCheck& c = checks[i];
+      state.setVariablePositions(trajectory.getWayPoint(c.index).getVariablePositions());
+      state.update();
+      bool state_valid = c.check_collision ? scene->isStateValid(state,group_,true) :
+          scene->isStateFeasible(state,true);
+      if(!state_valid)
+      {
+        valid = false;
+      }
+    }
+  };
+
+  std::size_t num_threads = std::min<std::size_t>(num_validation_threads_,
+                                                  (checks.size() + MIN_WAYPOINTS_PER_VALIDATION_THREAD - 1)/
+                                                  MIN_WAYPOINTS_PER_VALIDATION_THREAD);
+  std::vector<std::thread> threads;
+  for(std::size_t i = 1; i < num_threads; i++)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  return valid;
+}
+
 bool StompPlanner::parametersToJointTrajectory(const Eigen::MatrixXd& parameters,
                                                trajectory_msgs::JointTrajectory& trajectory)
 {
@@ -733,6 +1272,7 @@ bool StompPlanner::canServiceRequest(const moveit_msgs::MotionPlanRequest &req)
 
 bool StompPlanner::terminate()
 {
+  terminated_ = true;
   if(stomp_)
   {
     if(!stomp_->cancel())
@@ -746,7 +1286,18 @@ bool StompPlanner::terminate()
 
 void StompPlanner::clear()
 {
+  stopRefinement();
   stomp_->clear();
+  terminated_ = false;
+}
+
+void StompPlanner::cancelIfTerminated()
+{
+  // setting the configuration resumes Stomp, so a termination that arrived during the setup is applied again
+  if(terminated_)
+  {
+    stomp_->cancel();
+  }
 }
 
 bool StompPlanner::getConfigData(ros::NodeHandle &nh, std::map<std::string, XmlRpc::XmlRpcValue> &config, std::string param)
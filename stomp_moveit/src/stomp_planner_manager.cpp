@@ -26,6 +26,19 @@
 #include <class_loader/class_loader.hpp>
 #include <stomp_moveit/stomp_planner_manager.h>
 #include <stomp_moveit/stomp_planner.h>
+#include <moveit/robot_state/conversions.h>
+#include <stomp_core/trace.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+static const int DEFAULT_NUM_PLANNING_CONTEXTS = 1;
+static const std::string DEFAULT_PROFILE_NAME = "default";
+static const double DEFAULT_STATISTICS_PUBLISH_PERIOD = 10.0;
+static const double DEFAULT_OBJECTIVE_PERCENTILE = 0.99;
+static const int DEFAULT_TRACE_MAX_EVENTS = 1000000;
+static const std::vector<std::string> PROFILE_EXCLUDED_PARAMETERS = {"profiles", "rollout_workers"}; // not inherited by the profiles
 
 namespace stomp_moveit
 {
@@ -39,7 +52,25 @@ StompPlannerManager::StompPlannerManager():
 
 StompPlannerManager::~StompPlannerManager()
 {
+  for(const auto& l : trajectory_libraries_)
+  {
+    if(l.second.save_on_shutdown && !l.second.file.empty())
+    {
+      l.second.library->save(l.second.file);
+    }
+  }
+
+  statistics_timer_.stop();
+  if(statistics_ && !statistics_file_.empty())
+  {
+    statistics_->save(statistics_file_);
+  }
 
+  if(!trace_file_.empty())
+  {
+    stomp_core::Tracer::getInstance().stop();
+    stomp_core::Tracer::getInstance().save(trace_file_);
+  }
 }
 
 bool StompPlannerManager::initialize(const robot_model::RobotModelConstPtr &model, const std::string &ns)
@@ -51,6 +82,34 @@ bool StompPlannerManager::initialize(const robot_model::RobotModelConstPtr &mode
 
   robot_model_ = model;
 
+  if(!setupPlanningStatistics())
+  {
+    return false;
+  }
+
+  // tracing all the planning work of the process, including the warm up, until the manager is destroyed
+  XmlRpc::XmlRpcValue trace_config;
+  if(nh_.getParam("stomp_trace",trace_config))
+  {
+    int max_events = DEFAULT_TRACE_MAX_EVENTS;
+    try
+    {
+      trace_file_ = static_cast<std::string>(trace_config["file"]);
+      if(trace_config.hasMember("max_events"))
+      {
+        max_events = static_cast<int>(trace_config["max_events"]);
+      }
+    }
+    catch(XmlRpc::XmlRpcException& e)
+    {
+      ROS_ERROR("Stomp 'stomp_trace' parameter failed to load; %s",e.getMessage().c_str());
+      return false;
+    }
+
+    stomp_core::Tracer::getInstance().start(std::max(max_events,0));
+    ROS_INFO("STOMP is tracing the planning work to '%s'",trace_file_.c_str());
+  }
+
   // each element under 'stomp' should be a group name
   std::map<std::string, XmlRpc::XmlRpcValue> group_config;
 
@@ -68,8 +127,91 @@ bool StompPlannerManager::initialize(const robot_model::RobotModelConstPtr &mode
       continue;
     }
 
-    std::shared_ptr<StompPlanner> planner(new StompPlanner(v->first, v->second, robot_model_));
-    planners_.insert(std::make_pair(v->first, planner));
+    int num_contexts = DEFAULT_NUM_PLANNING_CONTEXTS;
+    if(v->second.hasMember("num_planning_contexts"))
+    {
+      num_contexts = static_cast<int>(v->second["num_planning_contexts"]);
+    }
+
+    if(num_contexts < 1)
+    {
+      ROS_WARN("The 'num_planning_contexts' for group '%s' must be at least 1, creating a single planning context",v->first.c_str());
+      num_contexts = 1;
+    }
+
+    // the planners of the group and of its profiles share the library, loaded once for all of them
+    if(v->second.hasMember("trajectory_library") && !createTrajectoryLibrary(v->first,v->second["trajectory_library"]))
+    {
+      return false;
+    }
+
+    // the planning contexts of the group evaluate their rollouts in the same worker processes
+    if(v->second.hasMember("rollout_workers") && !createRolloutWorkers(v->first,v->second))
+    {
+      return false;
+    }
+
+    std::shared_ptr<PlannerPool> pool = createPlannerPool(v->first,DEFAULT_PROFILE_NAME,v->second,num_contexts);
+    if(v->second.hasMember("plan_cache"))
+    {
+      try
+      {
+        plan_caches_.insert(std::make_pair(v->first, std::make_shared<PlanCache>(v->first, v->second["plan_cache"])));
+      }
+      catch(XmlRpc::XmlRpcException& e)
+      {
+        ROS_ERROR("Stomp 'plan_cache' parameter for group '%s' failed to load; %s",v->first.c_str(),e.getMessage().c_str());
+        return false;
+      }
+    }
+
+    planners_.insert(std::make_pair(v->first, pool->idle.front()));
+    planner_pools_.insert(std::make_pair(v->first, pool));
+    ROS_INFO("STOMP created %i planning context(s) for group '%s'",num_contexts,v->first.c_str());
+
+    // each profile overrides the group parameters it contains and has its own planning contexts. It inherits the
+    // other group parameters except the per process resources, it shares the group's plan cache and trajectory library
+    if(v->second.hasMember("profiles"))
+    {
+      try
+      {
+        XmlRpc::XmlRpcValue& profiles = v->second["profiles"];
+        for(XmlRpc::XmlRpcValue::iterator p = profiles.begin(); p != profiles.end(); p++)
+        {
+          XmlRpc::XmlRpcValue profile_config;
+          for(XmlRpc::XmlRpcValue::iterator m = v->second.begin(); m != v->second.end(); m++)
+          {
+            if(std::find(PROFILE_EXCLUDED_PARAMETERS.begin(),PROFILE_EXCLUDED_PARAMETERS.end(),m->first) ==
+                PROFILE_EXCLUDED_PARAMETERS.end())
+            {
+              profile_config[m->first] = m->second;
+            }
+          }
+
+          for(XmlRpc::XmlRpcValue::iterator m = p->second.begin(); m != p->second.end(); m++)
+          {
+            profile_config[m->first] = m->second;
+          }
+
+          int num_profile_contexts = DEFAULT_NUM_PLANNING_CONTEXTS;
+          if(p->second.hasMember("num_planning_contexts"))
+          {
+            num_profile_contexts = std::max(static_cast<int>(p->second["num_planning_contexts"]),1);
+          }
+
+          std::shared_ptr<PlannerPool> profile_pool = createPlannerPool(v->first,p->first,profile_config,
+                                                                        num_profile_contexts);
+          profile_pools_[v->first].insert(std::make_pair(p->first, profile_pool));
+          ROS_INFO("STOMP created %i planning context(s) for profile '%s' of group '%s'",num_profile_contexts,
+                   p->first.c_str(),v->first.c_str());
+        }
+      }
+      catch(XmlRpc::XmlRpcException& e)
+      {
+        ROS_ERROR("Stomp 'profiles' parameter for group '%s' failed to load; %s",v->first.c_str(),e.getMessage().c_str());
+        return false;
+      }
+    }
   }
 
   if(planners_.empty())
@@ -78,9 +220,248 @@ bool StompPlannerManager::initialize(const robot_model::RobotModelConstPtr &mode
     return false;
   }
 
+  // warming up the planners of the groups and profiles that request it, each on its own thread
+  std::vector< std::shared_ptr<PlannerPool> > pools;
+  for(const auto& p : planner_pools_)
+  {
+    pools.push_back(p.second);
+  }
+
+  for(const auto& g : profile_pools_)
+  {
+    for(const auto& p : g.second)
+    {
+      pools.push_back(p.second);
+    }
+  }
+
+  std::vector<std::thread> warm_ups;
+  for(const auto& pool : pools)
+  {
+    if(!pool->warm_up)
+    {
+      continue;
+    }
+
+    for(auto& planner : pool->idle)
+    {
+      warm_ups.emplace_back(&StompPlanner::warmUp,planner.get());
+    }
+  }
+
+  for(auto& t : warm_ups)
+  {
+    t.join();
+  }
+
+  return true;
+}
+
+std::shared_ptr<StompPlannerManager::PlannerPool> StompPlannerManager::createPlannerPool(const std::string& group,
+                                                                                       const std::string& profile,
+                                                                                       XmlRpc::XmlRpcValue& config,
+                                                                                       int num_contexts) const
+{
+  // each planner owns its optimizer and task so that requests for the same group can be solved in parallel
+  std::shared_ptr<PlannerPool> pool(new PlannerPool());
+  for(int i = 0; i < num_contexts; i++)
+  {
+    pool->idle.push_back(std::make_shared<StompPlanner>(group, config, robot_model_));
+  }
+
+  // the planners of a group learn from each other's solutions, those of a pool record their statistics together
+  utils::TrajectoryLibraryPtr library;
+  auto l = trajectory_libraries_.find(group);
+  if(l != trajectory_libraries_.end())
+  {
+    library = l->second.library;
+  }
+
+  // the workers load the group's task, the profiles do not inherit them
+  RolloutWorkerPoolPtr workers;
+  auto w = rollout_worker_pools_.find(group);
+  if(w != rollout_worker_pools_.end() && config.hasMember("rollout_workers"))
+  {
+    workers = w->second;
+  }
+
+  for(auto& planner : pool->idle)
+  {
+    planner->setTrajectoryLibrary(library);
+    planner->setRolloutWorkers(workers);
+    planner->setPlanningStatistics(statistics_,profile);
+  }
+
+  pool->size = pool->idle.size();
+  pool->warm_up = config.hasMember("warm_up") && static_cast<bool>(config["warm_up"]);
+  return pool;
+}
+
+bool StompPlannerManager::createTrajectoryLibrary(const std::string& group, XmlRpc::XmlRpcValue& config)
+{
+  TrajectoryLibraryEntry entry;
+  entry.save_on_shutdown = false;
+  int capacity = 0;
+  try
+  {
+    capacity = static_cast<int>(config["capacity"]);
+    if(config.hasMember("file"))
+    {
+      entry.file = static_cast<std::string>(config["file"]);
+    }
+
+    if(config.hasMember("save_on_shutdown"))
+    {
+      entry.save_on_shutdown = static_cast<bool>(config["save_on_shutdown"]);
+    }
+  }
+  catch(XmlRpc::XmlRpcException& e)
+  {
+    ROS_ERROR("Stomp 'trajectory_library' parameter for group '%s' failed to load; %s",group.c_str(),e.getMessage().c_str());
+    return false;
+  }
+
+  if(capacity < 1)
+  {
+    ROS_ERROR("Stomp 'trajectory_library' parameter for group '%s' is invalid",group.c_str());
+    return false;
+  }
+
+  const auto& joint_names = robot_model_->getJointModelGroup(group)->getActiveJointModelNames();
+  entry.library = std::make_shared<utils::TrajectoryLibrary>(group,joint_names,capacity);
+
+  // a missing file is expected before the first save
+  if(!entry.file.empty() && std::ifstream(entry.file).good())
+  {
+    entry.library->load(entry.file);
+  }
+
+  trajectory_libraries_[group] = entry;
   return true;
 }
 
+bool StompPlannerManager::createRolloutWorkers(const std::string& group, XmlRpc::XmlRpcValue& config)
+{
+  try
+  {
+    rollout_worker_pools_[group] = std::make_shared<RolloutWorkerPool>(group,config["task"],config["rollout_workers"]);
+  }
+  catch(XmlRpc::XmlRpcException& e)
+  {
+    ROS_ERROR("Stomp 'rollout_workers' parameter for group '%s' failed to load; %s",group.c_str(),e.getMessage().c_str());
+    return false;
+  }
+  catch(std::logic_error& e)
+  {
+    ROS_ERROR("%s",e.what());
+    return false;
+  }
+
+  return true;
+}
+
+bool StompPlannerManager::setupPlanningStatistics()
+{
+  double publish_period = DEFAULT_STATISTICS_PUBLISH_PERIOD;
+  double latency_objective = 0.0;
+  double objective_percentile = DEFAULT_OBJECTIVE_PERCENTILE;
+
+  XmlRpc::XmlRpcValue config;
+  if(nh_.getParam("stomp_statistics",config))
+  {
+    try
+    {
+      if(config.hasMember("publish_period"))
+      {
+        publish_period = static_cast<double>(config["publish_period"]);
+      }
+
+      if(config.hasMember("latency_objective"))
+      {
+        latency_objective = static_cast<double>(config["latency_objective"]);
+      }
+
+      if(config.hasMember("objective_percentile"))
+      {
+        objective_percentile = static_cast<double>(config["objective_percentile"]);
+      }
+
+      if(config.hasMember("file"))
+      {
+        statistics_file_ = static_cast<std::string>(config["file"]);
+      }
+    }
+    catch(XmlRpc::XmlRpcException& e)
+    {
+      ROS_ERROR("Stomp 'stomp_statistics' parameter failed to load; %s",e.getMessage().c_str());
+      return false;
+    }
+  }
+
+  if(objective_percentile <= 0.0 || objective_percentile > 1.0)
+  {
+    ROS_ERROR("Stomp 'stomp_statistics/objective_percentile' parameter must be within (0, 1]");
+    return false;
+  }
+
+  statistics_ = std::make_shared<PlanningStatistics>(latency_objective,objective_percentile);
+  if(publish_period > 0.0)
+  {
+    statistics_pub_ = nh_.advertise<diagnostic_msgs::DiagnosticArray>("stomp_statistics",1);
+    statistics_timer_ = nh_.createWallTimer(ros::WallDuration(publish_period),[this](const ros::WallTimerEvent&)
+    {
+      publishPlanningStatistics();
+    });
+  }
+
+  return true;
+}
+
+void StompPlannerManager::publishPlanningStatistics() const
+{
+  diagnostic_msgs::DiagnosticArray msg;
+  statistics_->getDiagnostics(msg);
+  msg.header.stamp = ros::Time::now();
+  statistics_pub_.publish(msg);
+
+  if(!statistics_file_.empty())
+  {
+    statistics_->save(statistics_file_);
+  }
+}
+
+PlanningStatisticsPtr StompPlannerManager::getPlanningStatistics() const
+{
+  return statistics_;
+}
+
+std::shared_ptr<StompPlannerManager::PlannerPool> StompPlannerManager::getPlannerPool(
+    const moveit_msgs::MotionPlanRequest &req) const
+{
+  auto g = profile_pools_.find(req.group_name);
+  if(!req.planner_id.empty() && g != profile_pools_.end())
+  {
+    // the profile is named either alone or as 'group[profile]'
+    std::string profile = req.planner_id;
+    std::string prefix = req.group_name + "[";
+    if(profile.size() > prefix.size() && profile.compare(0,prefix.size(),prefix) == 0 && profile.back() == ']')
+    {
+      profile = profile.substr(prefix.size(),profile.size() - prefix.size() - 1);
+    }
+
+    auto p = g->second.find(profile);
+    if(p != g->second.end())
+    {
+      return p->second;
+    }
+
+    ROS_DEBUG("STOMP group '%s' has no profile '%s', using the default parameters",req.group_name.c_str(),
+              req.planner_id.c_str());
+  }
+
+  return planner_pools_.at(req.group_name);
+}
+
 bool StompPlannerManager::canServiceRequest(const moveit_msgs::MotionPlanRequest &req) const
 {
   if(planners_.count(req.group_name) == 0)
@@ -100,6 +481,17 @@ void StompPlannerManager::getPlanningAlgorithms(std::vector<std::string> &algs)
   {
     algs.push_back(planners_.begin()->second->getName());
   }
+
+  for(const auto& g : profile_pools_)
+  {
+    for(const auto& p : g.second)
+    {
+      if(std::find(algs.begin(),algs.end(),p.first) == algs.end())
+      {
+        algs.push_back(p.first);
+      }
+    }
+  }
 }
 
 void StompPlannerManager::setPlannerConfigurations(const planning_interface::PlannerConfigurationMap &pcs)
@@ -107,6 +499,21 @@ void StompPlannerManager::setPlannerConfigurations(const planning_interface::Pla
   ROS_WARN_STREAM("The "<<__FUNCTION__<<" method is not applicable");
 }
 
+void StompPlannerManager::getPlanningGroups(std::vector<std::string> &groups) const
+{
+  groups.clear();
+  for(const auto& p : planner_pools_)
+  {
+    groups.push_back(p.first);
+  }
+}
+
+std::size_t StompPlannerManager::getNumPlanningContexts(const std::string& group) const
+{
+  auto p = planner_pools_.find(group);
+  return p == planner_pools_.end() ? 0 : p->second->size;
+}
+
 planning_interface::PlanningContextPtr StompPlannerManager::getPlanningContext(const planning_scene::PlanningSceneConstPtr &planning_scene,
                                                                                const planning_interface::MotionPlanRequest &req,
                                                                                moveit_msgs::MoveItErrorCodes &error_code) const
@@ -134,22 +541,132 @@ planning_interface::PlanningContextPtr StompPlannerManager::getPlanningContext(c
     return planning_interface::PlanningContextPtr();
   }
 
-  // Get planner
-  std::shared_ptr<StompPlanner> planner = std::static_pointer_cast<StompPlanner>(planners_.at(req.group_name));
-
-  if(!planner->canServiceRequest(req))
+  if(!canServiceRequest(req))
   {
     error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
     return planning_interface::PlanningContextPtr();
   }
 
+  // Look for a previous plan of the same request that is still valid
+  PlanCachePtr cache;
+  PlanCache::Key key;
+  if(plan_caches_.count(req.group_name) > 0)
+  {
+    cache = plan_caches_.at(req.group_name);
+    moveit_msgs::RobotTrajectory cached_msg;
+    if(!cache->computeKey(planning_scene,req,key))
+    {
+      cache.reset();
+    }
+    else if(cache->lookup(key,cached_msg))
+    {
+      moveit::core::RobotState start_state(planning_scene->getCurrentState());
+      moveit::core::robotStateMsgToRobotState(req.start_state,start_state);
+      robot_trajectory::RobotTrajectoryPtr trajectory(new robot_trajectory::RobotTrajectory(robot_model_,req.group_name));
+      trajectory->setRobotTrajectoryMsg(start_state,cached_msg);
+      if(planning_scene->isPathValid(*trajectory,req.group_name,true))
+      {
+        ROS_DEBUG("STOMP found a cached plan for group %s",req.group_name.c_str());
+        std::shared_ptr<PlanCacheContext> context(new PlanCacheContext(planners_.at(req.group_name)->getName(),
+                                                                       req.group_name,trajectory));
+        context->setPlanningScene(planning_scene);
+        context->setMotionPlanRequest(req);
+        return context;
+      }
+
+      cache->erase(key);
+    }
+  }
+
+  // Check out a planner, waiting for one to be returned when all are in use
+  std::shared_ptr<PlannerPool> pool = getPlannerPool(req);
+  std::shared_ptr<StompPlanner> planner;
+  {
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    std::chrono::duration<double> allowed_time(req.allowed_planning_time);
+    if(!pool->available.wait_for(lock,allowed_time,[&pool](){ return !pool->idle.empty(); }))
+    {
+      ROS_ERROR("STOMP has no planning context available for group %s within the allowed planning time",req.group_name.c_str());
+      error_code.val = moveit_msgs::MoveItErrorCodes::TIMED_OUT;
+      return planning_interface::PlanningContextPtr();
+    }
+
+    planner = pool->idle.back();
+    pool->idle.pop_back();
+  }
+
   // Setup Planner
   planner->clear();
   planner->setPlanningScene(planning_scene);
   planner->setMotionPlanRequest(req);
 
-  // Return Planner
-  return planner;
+  // Return Planner, it goes back into the pool when the caller releases it
+  planning_interface::PlanningContextPtr context(planner.get(),[pool, planner](planning_interface::PlanningContext*)
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->idle.push_back(planner);
+    pool->available.notify_one();
+  });
+
+  if(cache)
+  {
+    std::shared_ptr<PlanCacheContext> caching_context(new PlanCacheContext(context,cache,key));
+    caching_context->setPlanningScene(planning_scene);
+    caching_context->setMotionPlanRequest(req);
+    return caching_context;
+  }
+
+  return context;
+}
+
+bool StompPlannerManager::solveBatch(const planning_scene::PlanningSceneConstPtr &planning_scene,
+                                     const std::vector<planning_interface::MotionPlanRequest> &requests,
+                                     std::vector<planning_interface::MotionPlanResponse> &responses) const
+{
+  responses.clear();
+  responses.resize(requests.size());
+
+  // grouping the requests so that each group's workers never wait on another group's planners
+  std::map<std::string, std::vector<std::size_t> > group_requests;
+  for(std::size_t i = 0; i < requests.size(); i++)
+  {
+    group_requests[requests[i].group_name].push_back(i);
+  }
+
+  std::vector<std::thread> workers;
+  std::atomic<bool> success(true);
+  for(const auto& g : group_requests)
+  {
+    const std::vector<std::size_t>* indices = &g.second;
+    std::size_t num_workers = std::min(indices->size(),getNumPlanningContexts(g.first));
+    num_workers = std::max<std::size_t>(num_workers,1); // unsupported groups are reported by getPlanningContext
+
+    // the workers of a group take the next unsolved request until there are none left
+    std::shared_ptr< std::atomic<std::size_t> > next = std::make_shared< std::atomic<std::size_t> >(0);
+    for(std::size_t w = 0; w < num_workers; w++)
+    {
+      workers.emplace_back([&, next, indices]()
+      {
+        for(std::size_t n = (*next)++; n < indices->size(); n = (*next)++)
+        {
+          std::size_t i = (*indices)[n];
+          planning_interface::PlanningContextPtr context = getPlanningContext(planning_scene,requests[i],responses[i].error_code_);
+          if(!context || !context->solve(responses[i]))
+          {
+            ROS_ERROR("STOMP failed to solve batch request %lu for group '%s'",i,requests[i].group_name.c_str());
+            success = false;
+          }
+        }
+      });
+    }
+  }
+
+  for(auto& w : workers)
+  {
+    w.join();
+  }
+
+  return success;
 }
 
 
@@ -0,0 +1,273 @@
+/**
+ * @file stomp_planning_service.cpp
+ * @brief This defines a prioritized planning request queue on top of the stomp planner manager
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stomp_moveit/stomp_planning_service.h>
+#include <ros/console.h>
+#include <algorithm>
+
+namespace stomp_moveit
+{
+
+bool StompPlanningService::JobOrder::operator()(const Job& a, const Job& b) const
+{
+  // returns true when 'a' is solved after 'b'
+  if(a.priority != b.priority)
+  {
+    return a.priority < b.priority;
+  }
+
+  if(a.deadline != b.deadline)
+  {
+    if(a.deadline.isZero() || b.deadline.isZero())
+    {
+      return a.deadline.isZero();
+    }
+    return a.deadline > b.deadline;
+  }
+
+  return a.sequence > b.sequence;
+}
+
+StompPlanningService::StompPlanningService(std::shared_ptr<StompPlannerManager> manager):
+    manager_(manager),
+    stop_(false),
+    sequence_(0)
+{
+  std::vector<std::string> group_names;
+  manager_->getPlanningGroups(group_names);
+
+  // creating all the queues before any worker starts
+  for(const auto& name : group_names)
+  {
+    std::shared_ptr<GroupQueue> group(new GroupQueue());
+    group->solves.resize(manager_->getNumPlanningContexts(name));
+    groups_.insert(std::make_pair(name,group));
+  }
+
+  for(auto& g : groups_)
+  {
+    GroupQueue& group = *g.second;
+    for(std::size_t i = 0; i < group.solves.size(); i++)
+    {
+      group.workers.emplace_back(&StompPlanningService::run,this,std::ref(group),i);
+    }
+  }
+}
+
+StompPlanningService::~StompPlanningService()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    for(auto& g : groups_)
+    {
+      for(auto& s : g.second->solves)
+      {
+        if(s.active && s.context)
+        {
+          s.context->terminate();
+        }
+      }
+      g.second->available.notify_all();
+    }
+  }
+
+  for(auto& g : groups_)
+  {
+    for(auto& w : g.second->workers)
+    {
+      w.join();
+    }
+
+    // failing the requests that were never started
+    while(!g.second->pending.empty())
+    {
+      planning_interface::MotionPlanResponse res;
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      g.second->pending.top().response->set_value(res);
+      g.second->pending.pop();
+    }
+  }
+}
+
+std::future<planning_interface::MotionPlanResponse> StompPlanningService::submit(
+    const planning_scene::PlanningSceneConstPtr& planning_scene,
+    const planning_interface::MotionPlanRequest& req,
+    int priority,
+    ros::WallTime deadline)
+{
+  Job job;
+  job.planning_scene = planning_scene;
+  job.request = req;
+  job.priority = priority;
+  job.deadline = deadline;
+  job.response = std::make_shared< std::promise<planning_interface::MotionPlanResponse> >();
+  std::future<planning_interface::MotionPlanResponse> future = job.response->get_future();
+
+  auto g = groups_.find(req.group_name);
+  if(g == groups_.end())
+  {
+    ROS_ERROR("STOMP planning service does not support the planning group '%s'",req.group_name.c_str());
+    planning_interface::MotionPlanResponse res;
+    res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_GROUP_NAME;
+    job.response->set_value(res);
+    return future;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  job.sequence = sequence_++;
+  preempt(*g->second,priority);
+  g->second->pending.push(job);
+  g->second->available.notify_one();
+
+  return future;
+}
+
+std::size_t StompPlanningService::getNumPending() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t count = 0;
+  for(const auto& g : groups_)
+  {
+    count += g.second->pending.size();
+  }
+  return count;
+}
+
+void StompPlanningService::preempt(GroupQueue& group, int priority)
+{
+  // a worker that is free or will pick up a pending request first makes preemption unnecessary
+  std::size_t num_active = 0;
+  Solve* lowest = nullptr;
+  for(auto& s : group.solves)
+  {
+    if(!s.active || s.preempted)
+    {
+      continue;
+    }
+
+    num_active++;
+    if(!lowest || s.priority < lowest->priority)
+    {
+      lowest = &s;
+    }
+  }
+
+  if(num_active + group.pending.size() < group.solves.size() || !lowest || lowest->priority >= priority)
+  {
+    return;
+  }
+
+  ROS_INFO("STOMP planning service preempting a request of priority %i for one of priority %i",lowest->priority,priority);
+  lowest->preempted = true;
+  if(lowest->context)
+  {
+    lowest->context->terminate();
+  }
+}
+
+void StompPlanningService::run(GroupQueue& group, std::size_t index)
+{
+  while(true)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      group.available.wait(lock,[&](){ return stop_ || !group.pending.empty(); });
+      if(stop_)
+      {
+        return;
+      }
+
+      job = group.pending.top();
+      group.pending.pop();
+
+      Solve& s = group.solves[index];
+      s.active = true;
+      s.preempted = false;
+      s.priority = job.priority;
+    }
+
+    planning_interface::MotionPlanResponse res;
+    bool requeue = solve(group,index,job,res);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Solve& s = group.solves[index];
+    s.active = false;
+    s.preempted = false;
+    s.context.reset();
+
+    if(requeue && !stop_)
+    {
+      group.pending.push(job);
+      group.available.notify_one();
+    }
+    else
+    {
+      if(requeue)
+      {
+        res.error_code_.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      }
+      job.response->set_value(res);
+    }
+  }
+}
+
+bool StompPlanningService::solve(GroupQueue& group, std::size_t index, Job& job, planning_interface::MotionPlanResponse& res)
+{
+  // limiting the planning time to the deadline
+  if(!job.deadline.isZero())
+  {
+    double remaining = (job.deadline - ros::WallTime::now()).toSec();
+    if(remaining <= 0.0)
+    {
+      ROS_ERROR("STOMP planning service request for group '%s' missed its deadline",job.request.group_name.c_str());
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::TIMED_OUT;
+      return false;
+    }
+    job.request.allowed_planning_time = std::min(job.request.allowed_planning_time,remaining);
+  }
+
+  moveit_msgs::MoveItErrorCodes error_code;
+  planning_interface::PlanningContextPtr context = manager_->getPlanningContext(job.planning_scene,job.request,error_code);
+  if(!context)
+  {
+    res.error_code_ = error_code;
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Solve& s = group.solves[index];
+    if(s.preempted)
+    {
+      return true;
+    }
+    s.context = context;
+  }
+
+  bool success = context->solve(res);
+
+  // a solve that completed before the cancellation took effect keeps its result
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !success && group.solves[index].preempted;
+}
+
+} /* namespace stomp_moveit */
@@ -27,11 +27,8 @@
  */
 #include <stomp_moveit/update_filters/control_cost_projection.h>
 #include <ros/console.h>
-#include <pluginlib/class_list_macros.h>
 #include <stomp_core/utils.h>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::update_filters::ControlCostProjection,stomp_moveit::update_filters::StompUpdateFilter);
-
 
 namespace stomp_moveit
 {
@@ -79,7 +76,17 @@ bool ControlCostProjection::setMotionPlanRequest(const planning_scene::PlanningS
                  moveit_msgs::MoveItErrorCodes& error_code)
 {
 
-  num_timesteps_ = config.num_timesteps;
+  num_timesteps_ = stomp_core::getNumParameters(config);
+
+  // reusing the matrix from a previous request of the same size
+  auto cached = projection_matrices_.find(num_timesteps_);
+  if(cached != projection_matrices_.end())
+  {
+    projection_matrix_M_ = cached->second;
+    error_code.val = error_code.SUCCESS;
+    return true;
+  }
+
   stomp_core::generateSmoothingMatrix(num_timesteps_,DEFAULT_TIME_STEP,projection_matrix_M_);
 
   // zeroing out first and last rows
@@ -87,6 +94,7 @@ bool ControlCostProjection::setMotionPlanRequest(const planning_scene::PlanningS
   projection_matrix_M_(0,0) = 1.0;
   projection_matrix_M_.bottomRows(1) = Eigen::VectorXd::Zero(num_timesteps_).transpose();
   projection_matrix_M_(num_timesteps_ -1 ,num_timesteps_ -1 ) = 1;
+  projection_matrices_[num_timesteps_] = projection_matrix_M_;
 
   error_code.val = error_code.SUCCESS;
   return true;
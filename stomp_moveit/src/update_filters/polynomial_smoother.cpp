@@ -30,13 +30,10 @@
 #include <eigen_conversions/eigen_msg.h>
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/robot_state/conversions.h>
-#include <pluginlib/class_list_macros.h>
 #include <stomp_moveit/update_filters/polynomial_smoother.h>
 #include <stomp_moveit/utils/polynomial.h>
 #include <XmlRpcException.h>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::update_filters::PolynomialSmoother,stomp_moveit::update_filters::StompUpdateFilter)
-
 namespace stomp_moveit
 {
 namespace update_filters
@@ -25,11 +25,8 @@
  */
 #include <moveit/robot_state/conversions.h>
 #include <tf/transform_datatypes.h>
-#include <pluginlib/class_list_macros.h>
 #include <stomp_moveit/update_filters/trajectory_visualization.h>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::update_filters::TrajectoryVisualization,stomp_moveit::update_filters::StompUpdateFilter);
-
 
 typedef std::vector<geometry_msgs::Point> ToolLine;
 using namespace moveit::core;
@@ -123,6 +120,7 @@ bool TrajectoryVisualization::initialize(moveit::core::RobotModelConstPtr robot_
                         const std::string& group_name,const XmlRpc::XmlRpcValue& config)
 {
   robot_model_ = robot_model_ptr;
+  state_pool_ = utils::RobotStatePool::get(robot_model_ptr);
   group_name_ = group_name;
 
   if(!configure(config))
@@ -199,7 +197,7 @@ bool TrajectoryVisualization::setMotionPlanRequest(const planning_scene::Plannin
                        marker_namespace_,tool_traj_marker_);
 
   // updating state
-  state_.reset(new RobotState(robot_model_));
+  state_ = state_pool_->checkout();
   if(!robotStateMsgToRobotState(req.start_state,*state_,true))
   {
     ROS_ERROR("%s Failed to get current robot state from request",getName().c_str());
@@ -27,12 +27,9 @@
 #include <stomp_moveit/update_filters/update_logger.h>
 #include <boost/filesystem.hpp>
 #include <ros/console.h>
-#include <pluginlib/class_list_macros.h>
 #include <ros/package.h>
 #include <Eigen/Core>
 
-PLUGINLIB_EXPORT_CLASS(stomp_moveit::update_filters::UpdateLogger,stomp_moveit::update_filters::StompUpdateFilter);
-
 namespace stomp_moveit
 {
 namespace update_filters
@@ -145,9 +142,9 @@ void UpdateLogger::done(bool success, int total_iterations,double final_cost,con
 
   // replacing values into header
   int rows = stomp_config_.num_dimensions * total_iterations;
-  int cols = stomp_config_.num_timesteps;
+  int cols = stomp_core::getNumParameters(stomp_config_);
   header.replace(header.find("@iterations"),std::string("@iterations").length(),std::to_string(total_iterations));
-  header.replace(header.find("@timesteps"),std::string("@timesteps").length(),std::to_string(stomp_config_.num_timesteps));
+  header.replace(header.find("@timesteps"),std::string("@timesteps").length(),std::to_string(cols));
   header.replace(header.find("@dimensions"),std::string("@dimensions").length(),std::to_string(stomp_config_.num_dimensions));
   header.replace(header.find("@rows"),std::string("@rows").length(),std::to_string(rows));
   header.replace(header.find("@cols"),std::string("@cols").length(),std::to_string(cols));
@@ -0,0 +1,73 @@
+/**
+ * @file hashing.cpp
+ * @brief This defines hashing utilities for ros messages and planning scenes
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stomp_moveit/utils/hashing.h>
+#include <moveit_msgs/PlanningScene.h>
+#include <moveit_msgs/PlanningSceneComponents.h>
+
+/**
+ * @namespace stomp_moveit
+ */
+namespace stomp_moveit
+{
+
+/**
+ * @namespace utils
+ */
+namespace utils
+{
+
+/**
+ * @namespace hashing
+ */
+namespace hashing
+{
+
+std::size_t hashPlanningScene(const planning_scene::PlanningSceneConstPtr& planning_scene, bool include_octomap)
+{
+  moveit_msgs::PlanningScene scene_msg;
+  moveit_msgs::PlanningSceneComponents components;
+  components.components = moveit_msgs::PlanningSceneComponents::WORLD_OBJECT_NAMES |
+      moveit_msgs::PlanningSceneComponents::WORLD_OBJECT_GEOMETRY |
+      (include_octomap ? moveit_msgs::PlanningSceneComponents::OCTOMAP : 0) |
+      moveit_msgs::PlanningSceneComponents::TRANSFORMS |
+      moveit_msgs::PlanningSceneComponents::ALLOWED_COLLISION_MATRIX |
+      moveit_msgs::PlanningSceneComponents::LINK_PADDING_AND_SCALING |
+      moveit_msgs::PlanningSceneComponents::ROBOT_STATE_ATTACHED_OBJECTS;
+  planning_scene->getPlanningSceneMsg(scene_msg,components);
+  scene_msg.robot_state.joint_state = sensor_msgs::JointState();
+  scene_msg.robot_state.multi_dof_joint_state = sensor_msgs::MultiDOFJointState();
+
+  // the transforms are stamped with the time of the copy
+  for(auto& t : scene_msg.fixed_frame_transforms)
+  {
+    t.header.stamp = ros::Time();
+    t.header.seq = 0;
+  }
+
+  return hashMessage(scene_msg);
+}
+
+} // end of namespace hashing
+
+} // end of namespace utils
+
+} // end of namespace stomp_moveit
@@ -25,6 +25,7 @@
  */
 
 #include <stomp_moveit/utils/kinematics.h>
+#include <stomp_core/trace.h>
 #include <kdl_parser/kdl_parser.hpp>
 #include <eigen_conversions/eigen_kdl.h>
 #include <math.h>
@@ -150,6 +151,7 @@ bool IKSolver::solve(const Eigen::VectorXd& seed,const Eigen::Affine3d& tool_pos
 bool IKSolver::solve(const std::vector<double>& seed, const Eigen::Affine3d& tool_pose,std::vector<double>& solution,
            std::vector<double> tol)
 {
+  stomp_core::TraceSpan span("IKSolver::solve","ik");
   using namespace KDL;
   using namespace Eigen;
   JntArray seed_kdl = toKDLJntArray(seed);
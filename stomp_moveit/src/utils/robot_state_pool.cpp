@@ -0,0 +1,112 @@
+/**
+ * @file robot_state_pool.cpp
+ * @brief This defines a pool of robot states reused across motion plan requests
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stomp_moveit/utils/robot_state_pool.h>
+#include <map>
+
+/**
+ * @namespace stomp_moveit
+ */
+namespace stomp_moveit
+{
+
+/**
+ * @namespace utils
+ */
+namespace utils
+{
+
+RobotStatePoolPtr RobotStatePool::get(moveit::core::RobotModelConstPtr robot_model)
+{
+  // a pool keeps its robot model alive so its address identifies the model for as long as the entry is not expired
+  static std::mutex mutex;
+  static std::map<const moveit::core::RobotModel*, std::weak_ptr<RobotStatePool> > pools;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::weak_ptr<RobotStatePool>& entry = pools[robot_model.get()];
+  RobotStatePoolPtr pool = entry.lock();
+  if(!pool)
+  {
+    pool = std::make_shared<RobotStatePool>(robot_model);
+    entry = pool;
+  }
+  return pool;
+}
+
+RobotStatePool::RobotStatePool(moveit::core::RobotModelConstPtr robot_model):
+    robot_model_(robot_model)
+{
+  moveit::core::RobotState* state = new moveit::core::RobotState(robot_model_);
+  state->setToDefaultValues();
+  state->update();
+  default_state_.reset(state);
+}
+
+moveit::core::RobotStatePtr RobotStatePool::checkout()
+{
+  return checkout(*default_state_);
+}
+
+moveit::core::RobotStatePtr RobotStatePool::checkout(const moveit::core::RobotState& source)
+{
+  using namespace moveit::core;
+
+  std::unique_ptr<RobotState> state;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(!available_.empty())
+    {
+      state = std::move(available_.back());
+      available_.pop_back();
+    }
+  }
+
+  if(state)
+  {
+    // copies the values and transforms into the memory of the state, the attached bodies are replaced
+    *state = source;
+  }
+  else
+  {
+    state.reset(new RobotState(source));
+  }
+
+  // the deleter also returns the state if the reference count can not be allocated
+  RobotStatePoolPtr pool = shared_from_this();
+  return RobotStatePtr(state.release(),[pool](RobotState* s){ pool->checkin(s); });
+}
+
+std::size_t RobotStatePool::getNumAvailable() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return available_.size();
+}
+
+void RobotStatePool::checkin(moveit::core::RobotState* state)
+{
+  std::unique_ptr<moveit::core::RobotState> s(state);
+  std::lock_guard<std::mutex> lock(mutex_);
+  available_.push_back(std::move(s));
+}
+
+} // end of namespace utils
+
+} // end of namespace stomp_moveit
@@ -0,0 +1,439 @@
+/**
+ * @file trajectory_library.cpp
+ * @brief This defines a library of previously planned trajectories used to seed new plans
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stomp_moveit/utils/trajectory_library.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char FILE_MAGIC[8] = "STOMPTL";
+static const uint32_t FILE_VERSION = 2;
+static const uint64_t FILE_ALIGNMENT = 8;
+
+/** @brief The header at the start of a trajectory library file */
+struct FileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t num_dimensions;
+  uint64_t num_entries;
+  uint64_t names_offset;
+  uint64_t names_size;
+  uint64_t entries_offset;
+};
+
+/** @brief The description of a trajectory in a library file */
+struct EntryRecord
+{
+  double cost;
+  uint32_t num_timesteps;
+  uint32_t reserved;
+  uint64_t data_offset;
+};
+
+/**
+ * @namespace stomp_moveit
+ */
+namespace stomp_moveit
+{
+
+/**
+ * @namespace utils
+ */
+namespace utils
+{
+
+TrajectoryLibrary::MappedFile::~MappedFile()
+{
+  if(address)
+  {
+    munmap(address,size);
+  }
+}
+
+TrajectoryLibrary::TrajectoryLibrary(const std::string& group, const std::vector<std::string>& joint_names,
+                                     std::size_t capacity):
+    group_(group),
+    joint_names_(joint_names),
+    num_dimensions_(static_cast<int>(joint_names.size())),
+    capacity_(capacity),
+    next_replaced_(0),
+    root_(-1)
+{
+  keys_.reserve(capacity_);
+  entries_.reserve(capacity_);
+  nodes_.reserve(capacity_);
+}
+
+void TrajectoryLibrary::add(const Eigen::MatrixXd& trajectory, double cost)
+{
+  if(trajectory.rows() != num_dimensions_ || trajectory.cols() < 2 || capacity_ == 0)
+  {
+    ROS_ERROR("Trajectory library can not store a trajectory of size [%i x %i]",
+              static_cast<int>(trajectory.rows()),static_cast<int>(trajectory.cols()));
+    return;
+  }
+
+  Eigen::VectorXd key(2*num_dimensions_);
+  key << trajectory.leftCols(1), trajectory.rightCols(1);
+  Entry entry{trajectory,nullptr,static_cast<int>(trajectory.cols()),cost};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(added_.size() < capacity_)
+  {
+    keys_.push_back(key);
+    entries_.push_back(entry);
+    added_.push_back(static_cast<int>(entries_.size()) - 1);
+
+    // rebalancing every time the size doubles keeps the insertion cost amortized
+    if((keys_.size() & (keys_.size() - 1)) == 0)
+    {
+      rebuild();
+    }
+    else
+    {
+      insert(added_.back());
+    }
+    return;
+  }
+
+  // replacing the oldest entry moves its key so the tree is rebuilt
+  int replaced = added_[next_replaced_];
+  keys_[replaced] = key;
+  entries_[replaced] = entry;
+  next_replaced_ = (next_replaced_ + 1) % capacity_;
+  rebuild();
+}
+
+bool TrajectoryLibrary::findNearest(const Eigen::VectorXd& start, const Eigen::VectorXd& goal, double max_distance,
+                                    Eigen::MatrixXd& trajectory) const
+{
+  if(start.size() != num_dimensions_ || goal.size() != num_dimensions_)
+  {
+    return false;
+  }
+
+  Eigen::VectorXd key(2*num_dimensions_);
+  key << start, goal;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  int best = -1;
+  double best_distance = max_distance * max_distance;
+  search(root_,key,best,best_distance);
+  if(best < 0)
+  {
+    return false;
+  }
+
+  const Entry& entry = entries_[best];
+  if(entry.data)
+  {
+    trajectory = Eigen::Map<const Eigen::MatrixXf>(entry.data,num_dimensions_,entry.num_timesteps).cast<double>();
+  }
+  else
+  {
+    trajectory = entry.trajectory;
+  }
+  return true;
+}
+
+bool TrajectoryLibrary::load(const std::string& filename)
+{
+  int fd = open(filename.c_str(),O_RDONLY);
+  if(fd < 0)
+  {
+    ROS_ERROR("Trajectory library file '%s' could not be opened",filename.c_str());
+    return false;
+  }
+
+  struct stat st;
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  if(fstat(fd,&st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(FileHeader))
+  {
+    file->size = st.st_size;
+    file->address = mmap(nullptr,file->size,PROT_READ,MAP_SHARED,fd,0);
+    if(file->address == MAP_FAILED)
+    {
+      file->address = nullptr;
+    }
+  }
+  close(fd);
+
+  if(!file->address)
+  {
+    ROS_ERROR("Trajectory library file '%s' could not be mapped",filename.c_str());
+    return false;
+  }
+
+  // validating the layout before any entry is referenced
+  const char* base = static_cast<const char*>(file->address);
+  const FileHeader* header = reinterpret_cast<const FileHeader*>(base);
+  auto within_file = [&](uint64_t offset, uint64_t size) -> bool
+  {
+    return offset <= file->size && size <= file->size - offset;
+  };
+
+  if(std::memcmp(header->magic,FILE_MAGIC,sizeof(header->magic)) != 0 || header->version != FILE_VERSION ||
+     header->num_dimensions != static_cast<uint32_t>(num_dimensions_) ||
+     header->num_entries > file->size / sizeof(EntryRecord) ||
+     !within_file(header->names_offset,header->names_size) ||
+     !within_file(header->entries_offset,header->num_entries * sizeof(EntryRecord)) ||
+     header->entries_offset % alignof(EntryRecord) != 0)
+  {
+    ROS_ERROR("Trajectory library file '%s' is not a valid library of %i joints",filename.c_str(),num_dimensions_);
+    return false;
+  }
+
+  std::vector<std::string> names;
+  const char* name = base + header->names_offset;
+  const char* names_end = name + header->names_size;
+  while(name < names_end)
+  {
+    const char* name_end = static_cast<const char*>(std::memchr(name,'\0',names_end - name));
+    if(!name_end)
+    {
+      break;
+    }
+    names.emplace_back(name,name_end);
+    name = name_end + 1;
+  }
+
+  if(names.size() != joint_names_.size() + 1 || names.front() != group_ ||
+     !std::equal(joint_names_.begin(),joint_names_.end(),names.begin() + 1))
+  {
+    ROS_ERROR("Trajectory library file '%s' was not made for the joints of group '%s'",filename.c_str(),group_.c_str());
+    return false;
+  }
+
+  const EntryRecord* records = reinterpret_cast<const EntryRecord*>(base + header->entries_offset);
+  std::vector<Entry> entries;
+  std::vector<Eigen::VectorXd> keys;
+  entries.reserve(header->num_entries);
+  keys.reserve(header->num_entries);
+  for(uint64_t i = 0; i < header->num_entries; i++)
+  {
+    const EntryRecord& r = records[i];
+    uint64_t num_values = static_cast<uint64_t>(num_dimensions_) * (2 + r.num_timesteps);
+    if(r.num_timesteps < 2 || r.data_offset % alignof(float) != 0 ||
+       !within_file(r.data_offset,num_values * sizeof(float)))
+    {
+      ROS_ERROR("Trajectory library file '%s' has an invalid entry %lu",filename.c_str(),static_cast<unsigned long>(i));
+      return false;
+    }
+
+    const float* data = reinterpret_cast<const float*>(base + r.data_offset);
+    keys.push_back(Eigen::Map<const Eigen::VectorXf>(data,2*num_dimensions_).cast<double>());
+    entries.push_back(Entry{Eigen::MatrixXd(),data + 2*num_dimensions_,static_cast<int>(r.num_timesteps),r.cost});
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  keys_.insert(keys_.end(),keys.begin(),keys.end());
+  entries_.insert(entries_.end(),entries.begin(),entries.end());
+  files_.push_back(file);
+  rebuild();
+
+  ROS_INFO("Trajectory library of group '%s' mapped %lu trajectories from '%s'",group_.c_str(),
+           static_cast<unsigned long>(entries.size()),filename.c_str());
+  return true;
+}
+
+bool TrajectoryLibrary::save(const std::string& filename) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto align = [](uint64_t offset) -> uint64_t
+  {
+    return (offset + FILE_ALIGNMENT - 1) / FILE_ALIGNMENT * FILE_ALIGNMENT;
+  };
+
+  std::string names = group_ + '\0';
+  for(const auto& n : joint_names_)
+  {
+    names += n + '\0';
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic,FILE_MAGIC,sizeof(header.magic));
+  header.version = FILE_VERSION;
+  header.num_dimensions = num_dimensions_;
+  header.num_entries = entries_.size();
+  header.names_offset = sizeof(FileHeader);
+  header.names_size = names.size();
+  header.entries_offset = align(header.names_offset + header.names_size);
+
+  std::vector<EntryRecord> records(entries_.size());
+  uint64_t offset = align(header.entries_offset + records.size() * sizeof(EntryRecord));
+  for(std::size_t i = 0; i < entries_.size(); i++)
+  {
+    records[i].cost = entries_[i].cost;
+    records[i].num_timesteps = entries_[i].num_timesteps;
+    records[i].reserved = 0;
+    records[i].data_offset = offset;
+    offset = align(offset + static_cast<uint64_t>(num_dimensions_) * (2 + entries_[i].num_timesteps) * sizeof(float));
+  }
+
+  // writing next to the destination and renaming it so that readers never see a partial file
+  std::string tmp_filename = filename + ".tmp";
+  std::ofstream out(tmp_filename,std::ios::binary | std::ios::trunc);
+  auto pad = [&](uint64_t offset)
+  {
+    static const char zeros[FILE_ALIGNMENT] = {};
+    out.write(zeros,align(offset) - offset);
+  };
+
+  out.write(reinterpret_cast<const char*>(&header),sizeof(header));
+  out.write(names.data(),names.size());
+  pad(header.names_offset + header.names_size);
+  out.write(reinterpret_cast<const char*>(records.data()),records.size() * sizeof(EntryRecord));
+  pad(header.entries_offset + records.size() * sizeof(EntryRecord));
+
+  Eigen::VectorXf values;
+  for(std::size_t i = 0; i < entries_.size(); i++)
+  {
+    const Entry& e = entries_[i];
+    values.resize(num_dimensions_ * (2 + e.num_timesteps));
+    values.head(2*num_dimensions_) = keys_[i].cast<float>();
+    Eigen::Map<Eigen::MatrixXf> trajectory(values.data() + 2*num_dimensions_,num_dimensions_,e.num_timesteps);
+    if(e.data)
+    {
+      trajectory = Eigen::Map<const Eigen::MatrixXf>(e.data,num_dimensions_,e.num_timesteps);
+    }
+    else
+    {
+      trajectory = e.trajectory.cast<float>();
+    }
+
+    out.write(reinterpret_cast<const char*>(values.data()),values.size() * sizeof(float));
+    pad(records[i].data_offset + values.size() * sizeof(float));
+  }
+
+  out.close();
+  if(!out || std::rename(tmp_filename.c_str(),filename.c_str()) != 0)
+  {
+    ROS_ERROR("Trajectory library file '%s' could not be written",filename.c_str());
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+std::size_t TrajectoryLibrary::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return keys_.size();
+}
+
+void TrajectoryLibrary::rebuild()
+{
+  std::vector<int> entries(keys_.size());
+  std::iota(entries.begin(),entries.end(),0);
+  nodes_.clear();
+  root_ = build(entries.begin(),entries.end(),0);
+}
+
+int TrajectoryLibrary::build(std::vector<int>::iterator begin, std::vector<int>::iterator end, int depth)
+{
+  if(begin == end)
+  {
+    return -1;
+  }
+
+  int axis = depth % (2*num_dimensions_);
+  auto median = begin + (end - begin)/2;
+  std::nth_element(begin,median,end,[&](int a, int b)
+  {
+    return keys_[a](axis) < keys_[b](axis);
+  });
+
+  int node = static_cast<int>(nodes_.size());
+  nodes_.push_back(Node{*median,axis,-1,-1});
+  int left = build(begin,median,depth + 1);
+  int right = build(median + 1,end,depth + 1);
+  nodes_[node].left = left;
+  nodes_[node].right = right;
+  return node;
+}
+
+void TrajectoryLibrary::insert(int entry)
+{
+  int node = static_cast<int>(nodes_.size());
+  const Eigen::VectorXd& key = keys_[entry];
+  if(root_ < 0)
+  {
+    nodes_.push_back(Node{entry,0,-1,-1});
+    root_ = node;
+    return;
+  }
+
+  int parent = root_;
+  while(true)
+  {
+    Node& p = nodes_[parent];
+    int& child = key(p.axis) < keys_[p.entry](p.axis) ? p.left : p.right;
+    if(child < 0)
+    {
+      int axis = (p.axis + 1) % (2*num_dimensions_);
+      child = node;
+      nodes_.push_back(Node{entry,axis,-1,-1});
+      return;
+    }
+    parent = child;
+  }
+}
+
+void TrajectoryLibrary::search(int node, const Eigen::VectorXd& key, int& best, double& best_distance) const
+{
+  if(node < 0)
+  {
+    return;
+  }
+
+  const Node& n = nodes_[node];
+  double distance = (keys_[n.entry] - key).squaredNorm();
+  if(distance <= best_distance)
+  {
+    best = n.entry;
+    best_distance = distance;
+  }
+
+  // visiting the far side only when the splitting plane is closer than the best match
+  double diff = key(n.axis) - keys_[n.entry](n.axis);
+  int near = diff < 0.0 ? n.left : n.right;
+  int far = diff < 0.0 ? n.right : n.left;
+  search(near,key,best,best_distance);
+  if(diff*diff <= best_distance)
+  {
+    search(far,key,best,best_distance);
+  }
+}
+
+} // end of namespace utils
+
+} // end of namespace stomp_moveit
@@ -0,0 +1,43 @@
+/**
+ * @file hashing.cpp
+ * @brief This contains gtest code for the planning scene hashing
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <geometric_shapes/shapes.h>
+#include <stomp_moveit/utils/hashing.h>
+#include "test_robot_model.h"
+
+using namespace stomp_moveit::utils::hashing;
+
+/** @brief This tests that the hash of a planning scene is stable and only changes with its contents */
+TEST(Hashing,planning_scene)
+{
+  planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(createTestRobotModel()));
+  std::size_t hash = hashPlanningScene(scene);
+  EXPECT_EQ(hashPlanningScene(scene),hash);
+
+  // the joint values are excluded
+  scene->getCurrentStateNonConst().setVariablePosition("joint1",0.5);
+  EXPECT_EQ(hashPlanningScene(scene),hash);
+
+  Eigen::Affine3d pose = Eigen::Affine3d::Identity();
+  pose.translation() << 1.0, 0.0, 0.0;
+  scene->getWorldNonConst()->addToObject("box",shapes::ShapeConstPtr(new shapes::Box(0.1,0.1,0.1)),pose);
+  EXPECT_NE(hashPlanningScene(scene),hash);
+}
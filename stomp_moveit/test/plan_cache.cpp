@@ -0,0 +1,211 @@
+/**
+ * @file plan_cache.cpp
+ * @brief This contains gtest code for the plan cache
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <geometric_shapes/shapes.h>
+#include <stomp_moveit/plan_cache.h>
+#include "test_robot_model.h"
+
+using namespace stomp_moveit;
+
+const double JOINT_RESOLUTION = 0.001;    /**< The resolution of the tested caches */
+
+/**
+ * @brief Creates a plan cache for the test robot
+ * @param capacity The number of cached trajectories
+ * @return The plan cache
+ */
+PlanCachePtr createPlanCache(int capacity)
+{
+  XmlRpc::XmlRpcValue config;
+  config["capacity"] = capacity;
+  config["joint_resolution"] = JOINT_RESOLUTION;
+  return std::make_shared<PlanCache>(TEST_GROUP,config);
+}
+
+/**
+ * @brief Creates a request with a joint goal and a position path constraint
+ * @param start The start joint values
+ * @param goal  The goal joint values
+ * @return The request
+ */
+moveit_msgs::MotionPlanRequest createRequest(const std::vector<double>& start, const std::vector<double>& goal)
+{
+  const std::vector<std::string> joint_names = {"joint1", "joint2"};
+  moveit_msgs::MotionPlanRequest req;
+  req.group_name = TEST_GROUP;
+  req.start_state.joint_state.name = joint_names;
+  req.start_state.joint_state.position = start;
+
+  moveit_msgs::Constraints goal_constraints;
+  for(std::size_t i = 0; i < joint_names.size(); i++)
+  {
+    moveit_msgs::JointConstraint jc;
+    jc.joint_name = joint_names[i];
+    jc.position = goal[i];
+    jc.tolerance_above = jc.tolerance_below = 0.01;
+    jc.weight = 1.0;
+    goal_constraints.joint_constraints.push_back(jc);
+  }
+  req.goal_constraints.push_back(goal_constraints);
+
+  moveit_msgs::PositionConstraint pc;
+  pc.header.frame_id = "base_link";
+  pc.header.stamp = ros::Time(1.0);
+  pc.header.seq = 1;
+  pc.link_name = "link2";
+  pc.weight = 1.0;
+  req.path_constraints.position_constraints.push_back(pc);
+  return req;
+}
+
+/**
+ * @brief Checks whether two keys identify the same request
+ * @param a The first key
+ * @param b The second key
+ * @return True if they are equal, otherwise false.
+ */
+bool equal(const PlanCache::Key& a, const PlanCache::Key& b)
+{
+  return !(a < b) && !(b < a);
+}
+
+/**
+ * @brief Creates a trajectory that is told apart by its number of points
+ * @param num_points The number of points
+ * @return The trajectory
+ */
+moveit_msgs::RobotTrajectory createTrajectory(int num_points)
+{
+  moveit_msgs::RobotTrajectory trajectory;
+  trajectory.joint_trajectory.points.resize(num_points);
+  return trajectory;
+}
+
+/** @brief This tests that a repeated request has the same key even when its constraints are stamped again */
+TEST(PlanCache,key_stability)
+{
+  planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(createTestRobotModel()));
+  PlanCachePtr cache = createPlanCache(10);
+
+  moveit_msgs::MotionPlanRequest req = createRequest({0.1, 0.2},{1.0, -1.0});
+  PlanCache::Key key;
+  ASSERT_TRUE(cache->computeKey(scene,req,key));
+
+  PlanCache::Key repeated_key;
+  ASSERT_TRUE(cache->computeKey(scene,req,repeated_key));
+  EXPECT_TRUE(equal(key,repeated_key));
+
+  req.path_constraints.position_constraints.front().header.stamp = ros::Time(2.0);
+  req.path_constraints.position_constraints.front().header.seq = 2;
+  PlanCache::Key restamped_key;
+  ASSERT_TRUE(cache->computeKey(scene,req,restamped_key));
+  EXPECT_TRUE(equal(key,restamped_key));
+
+  req.path_constraints.position_constraints.front().link_name = "link1";
+  PlanCache::Key other_key;
+  ASSERT_TRUE(cache->computeKey(scene,req,other_key));
+  EXPECT_FALSE(equal(key,other_key));
+}
+
+/** @brief This tests that the start and goal joint values only matter up to the joint resolution */
+TEST(PlanCache,key_quantization)
+{
+  planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(createTestRobotModel()));
+  PlanCachePtr cache = createPlanCache(10);
+
+  PlanCache::Key key;
+  ASSERT_TRUE(cache->computeKey(scene,createRequest({0.1, 0.2},{1.0, -1.0}),key));
+
+  const double small = 0.2*JOINT_RESOLUTION;
+  PlanCache::Key near_key;
+  ASSERT_TRUE(cache->computeKey(scene,createRequest({0.1 + small, 0.2 - small},{1.0 - small, -1.0 + small}),near_key));
+  EXPECT_TRUE(equal(key,near_key));
+
+  const double large = 2.0*JOINT_RESOLUTION;
+  PlanCache::Key start_key;
+  ASSERT_TRUE(cache->computeKey(scene,createRequest({0.1 + large, 0.2},{1.0, -1.0}),start_key));
+  EXPECT_FALSE(equal(key,start_key));
+
+  PlanCache::Key goal_key;
+  ASSERT_TRUE(cache->computeKey(scene,createRequest({0.1, 0.2},{1.0, -1.0 + large}),goal_key));
+  EXPECT_FALSE(equal(key,goal_key));
+}
+
+/** @brief This tests that the least recently used trajectory is evicted when the cache is full */
+TEST(PlanCache,lru_eviction)
+{
+  planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(createTestRobotModel()));
+  PlanCachePtr cache = createPlanCache(2);
+
+  PlanCache::Key key1, key2, key3;
+  ASSERT_TRUE(cache->computeKey(scene,createRequest({0.1, 0.2},{1.0, -1.0}),key1));
+  ASSERT_TRUE(cache->computeKey(scene,createRequest({0.3, 0.2},{1.0, -1.0}),key2));
+  ASSERT_TRUE(cache->computeKey(scene,createRequest({0.5, 0.2},{1.0, -1.0}),key3));
+
+  moveit_msgs::RobotTrajectory trajectory;
+  cache->insert(key1,createTrajectory(1));
+  cache->insert(key2,createTrajectory(2));
+
+  // the first one becomes the most recently used, so the second one is evicted
+  ASSERT_TRUE(cache->lookup(key1,trajectory));
+  EXPECT_EQ(trajectory.joint_trajectory.points.size(),1u);
+  cache->insert(key3,createTrajectory(3));
+
+  EXPECT_FALSE(cache->lookup(key2,trajectory));
+  ASSERT_TRUE(cache->lookup(key1,trajectory));
+  EXPECT_EQ(trajectory.joint_trajectory.points.size(),1u);
+  ASSERT_TRUE(cache->lookup(key3,trajectory));
+  EXPECT_EQ(trajectory.joint_trajectory.points.size(),3u);
+
+  cache->erase(key3);
+  EXPECT_FALSE(cache->lookup(key3,trajectory));
+}
+
+/** @brief This tests that a planning scene change empties the cache */
+TEST(PlanCache,scene_eviction)
+{
+  planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(createTestRobotModel()));
+  PlanCachePtr cache = createPlanCache(10);
+  moveit_msgs::MotionPlanRequest req = createRequest({0.1, 0.2},{1.0, -1.0});
+
+  PlanCache::Key key;
+  ASSERT_TRUE(cache->computeKey(scene,req,key));
+  cache->insert(key,createTrajectory(1));
+
+  // the current joint values of the scene do not change its contents
+  scene->getCurrentStateNonConst().setVariablePosition("joint1",0.5);
+  PlanCache::Key moved_key;
+  ASSERT_TRUE(cache->computeKey(scene,req,moved_key));
+  EXPECT_TRUE(equal(key,moved_key));
+
+  Eigen::Affine3d pose = Eigen::Affine3d::Identity();
+  pose.translation() << 1.0, 0.0, 0.0;
+  scene->getWorldNonConst()->addToObject("box",shapes::ShapeConstPtr(new shapes::Box(0.1,0.1,0.1)),pose);
+  PlanCache::Key changed_key;
+  ASSERT_TRUE(cache->computeKey(scene,req,changed_key));
+  EXPECT_FALSE(equal(key,changed_key));
+
+  moveit_msgs::RobotTrajectory trajectory;
+  cache->insert(changed_key,createTrajectory(2));
+  EXPECT_FALSE(cache->lookup(key,trajectory));
+  ASSERT_TRUE(cache->lookup(changed_key,trajectory));
+  EXPECT_EQ(trajectory.joint_trajectory.points.size(),2u);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file planning_statistics.cpp
+ * @brief This contains gtest code for the planning statistics
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <stomp_moveit/planning_statistics.h>
+#include <cmath>
+
+using namespace stomp_moveit;
+
+const double PERCENTILE_RESOLUTION = std::pow(10.0,0.1);    /**< The ratio between the edges of a histogram bin */
+
+/**
+ * @brief Creates the measurements of a request that reached every phase
+ * @param total     The total seconds of the request
+ * @param success   Whether the request succeeded
+ * @return The measurements
+ */
+PlanningStatistics::Sample createSample(double total, bool success)
+{
+  PlanningStatistics::Sample sample;
+  sample.durations.fill(0.0);
+  sample.durations[PlanningStatistics::OPTIMIZATION] = 0.5*total;
+  sample.durations[PlanningStatistics::TOTAL] = total;
+  sample.iterations = 10;
+  sample.success = success;
+  return sample;
+}
+
+/** @brief This tests that the percentiles are estimated within a bin of the exact ones */
+TEST(Histogram,percentiles)
+{
+  Histogram h;
+  EXPECT_EQ(h.getCount(),0u);
+  EXPECT_EQ(h.getPercentile(0.5),0.0);
+  EXPECT_EQ(h.getMax(),0.0);
+
+  const int num_values = 100;
+  for(int i = num_values; i > 0; i--)
+  {
+    h.add(1e-3*i);
+  }
+  EXPECT_EQ(h.getCount(),static_cast<std::size_t>(num_values));
+  EXPECT_NEAR(h.getMean(),1e-3*(num_values + 1)/2,1e-9);
+  EXPECT_DOUBLE_EQ(h.getMax(),1e-3*num_values);
+
+  for(double p : {0.01, 0.1, 0.5, 0.9, 0.99, 1.0})
+  {
+    double exact = 1e-3*std::ceil(p*num_values);
+    double estimate = h.getPercentile(p);
+    EXPECT_GE(estimate,exact - 1e-12) << "percentile " << p;
+    EXPECT_LE(estimate,exact*PERCENTILE_RESOLUTION + 1e-12) << "percentile " << p;
+  }
+}
+
+/** @brief This tests that the values outside of the bins are counted and the estimates stay within the values added */
+TEST(Histogram,range)
+{
+  Histogram small;
+  small.add(1e-6);
+  EXPECT_DOUBLE_EQ(small.getPercentile(0.5),1e-6);
+
+  Histogram large;
+  large.add(1e6);
+  EXPECT_DOUBLE_EQ(large.getPercentile(0.5),1e6);
+  EXPECT_DOUBLE_EQ(large.getMax(),1e6);
+
+  Histogram mixed;
+  mixed.add(1e-6);
+  mixed.add(1e6);
+  EXPECT_EQ(mixed.getCount(),2u);
+  EXPECT_LT(mixed.getPercentile(0.5),1e-3);
+  EXPECT_GT(mixed.getPercentile(1.0),1e3);
+}
+
+/** @brief This tests that the diagnostics warn once fewer requests than the target percentile meet the latency objective */
+TEST(PlanningStatistics,latency_objective)
+{
+  PlanningStatistics statistics(0.1,0.9);
+  for(int i = 0; i < 9; i++)
+  {
+    statistics.record("arm","default",createSample(0.05,true));
+  }
+  statistics.record("arm","default",createSample(0.2,true));
+  statistics.record("arm","fast",createSample(0.05,true));
+
+  diagnostic_msgs::DiagnosticArray msg;
+  statistics.getDiagnostics(msg);
+  ASSERT_EQ(msg.status.size(),2u);
+  EXPECT_EQ(msg.status[0].name,"stomp: arm[default]");
+  EXPECT_EQ(msg.status[0].level,diagnostic_msgs::DiagnosticStatus::OK);
+  EXPECT_EQ(msg.status[1].name,"stomp: arm[fast]");
+  EXPECT_EQ(msg.status[1].level,diagnostic_msgs::DiagnosticStatus::OK);
+
+  // a failed request does not meet the objective however fast it returns
+  statistics.record("arm","default",createSample(0.01,false));
+  statistics.getDiagnostics(msg);
+  ASSERT_EQ(msg.status.size(),2u);
+  EXPECT_EQ(msg.status[0].level,diagnostic_msgs::DiagnosticStatus::WARN);
+  EXPECT_EQ(msg.status[1].level,diagnostic_msgs::DiagnosticStatus::OK);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file test_robot_model.h
+ * @brief This defines a two joint robot model for the stomp_moveit tests
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef STOMP_MOVEIT_TEST_TEST_ROBOT_MODEL_H_
+#define STOMP_MOVEIT_TEST_TEST_ROBOT_MODEL_H_
+
+#include <moveit/robot_model/robot_model.h>
+#include <srdfdom/model.h>
+#include <urdf_parser/urdf_parser.h>
+
+static const std::string TEST_GROUP = "arm";      /**< The planning group of the test robot */
+
+static const std::string TEST_URDF =
+    "<robot name=\"test_robot\">"
+    "  <link name=\"base_link\"/>"
+    "  <link name=\"link1\"/>"
+    "  <link name=\"link2\"/>"
+    "  <joint name=\"joint1\" type=\"revolute\">"
+    "    <parent link=\"base_link\"/><child link=\"link1\"/>"
+    "    <axis xyz=\"0 0 1\"/><limit lower=\"-3.14\" upper=\"3.14\" effort=\"10\" velocity=\"1\"/>"
+    "  </joint>"
+    "  <joint name=\"joint2\" type=\"revolute\">"
+    "    <parent link=\"link1\"/><child link=\"link2\"/><origin xyz=\"0 0 0.5\"/>"
+    "    <axis xyz=\"0 1 0\"/><limit lower=\"-3.14\" upper=\"3.14\" effort=\"10\" velocity=\"1\"/>"
+    "  </joint>"
+    "</robot>";
+
+static const std::string TEST_SRDF =
+    "<robot name=\"test_robot\">"
+    "  <group name=\"arm\"><chain base_link=\"base_link\" tip_link=\"link2\"/></group>"
+    "</robot>";
+
+/**
+ * @brief Creates the model of the test robot
+ * @return The robot model
+ */
+inline moveit::core::RobotModelConstPtr createTestRobotModel()
+{
+  urdf::ModelInterfaceSharedPtr urdf_model = urdf::parseURDF(TEST_URDF);
+  srdf::ModelSharedPtr srdf_model(new srdf::Model());
+  srdf_model->initString(*urdf_model,TEST_SRDF);
+  return moveit::core::RobotModelConstPtr(new moveit::core::RobotModel(urdf_model,srdf_model));
+}
+
+#endif /* STOMP_MOVEIT_TEST_TEST_ROBOT_MODEL_H_ */
@@ -0,0 +1,260 @@
+/**
+ * @file trajectory_library.cpp
+ * @brief This contains gtest code for the trajectory library
+ *
+ * @date October 18, 2026
+ *
+ * @par License
+ * Software License Agreement (Apache License)
+ * @par
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * @par
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <stomp_moveit/utils/trajectory_library.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using namespace stomp_moveit::utils;
+
+const std::string LIBRARY_GROUP = "arm";                                  /**< The planning group of the libraries */
+const std::vector<std::string> LIBRARY_JOINTS = {"joint1", "joint2"};     /**< The joints of the libraries */
+const int LIBRARY_TIMESTEPS = 5;                                          /**< The timesteps of the trajectories */
+
+/**
+ * @brief Creates a trajectory that moves linearly from a start to a goal
+ * @param start The start joint values
+ * @param goal  The goal joint values
+ * @return The trajectory [num_joints x LIBRARY_TIMESTEPS]
+ */
+Eigen::MatrixXd createLinearTrajectory(const Eigen::Vector2d& start, const Eigen::Vector2d& goal)
+{
+  Eigen::MatrixXd trajectory(start.size(),LIBRARY_TIMESTEPS);
+  for(int t = 0; t < LIBRARY_TIMESTEPS; t++)
+  {
+    double s = static_cast<double>(t)/(LIBRARY_TIMESTEPS - 1);
+    trajectory.col(t) = (1.0 - s)*start + s*goal;
+  }
+  return trajectory;
+}
+
+/**
+ * @brief Gets a file name unique to the test process
+ * @param name The name of the file
+ * @return The file name in the temporary directory
+ */
+std::string getLibraryFileName(const std::string& name)
+{
+  return "/tmp/stomp_moveit_utest_" + std::to_string(getpid()) + "_" + name + ".trajlib";
+}
+
+/**
+ * @brief Overwrites a value in a file
+ * @param filename  The file
+ * @param offset    The offset of the value from the start of the file
+ * @param value     The value
+ */
+template <typename T>
+void patchFile(const std::string& filename, std::size_t offset, const T& value)
+{
+  std::fstream file(filename,std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(offset);
+  file.write(reinterpret_cast<const char*>(&value),sizeof(value));
+}
+
+/**
+ * @brief Reads a value from a file
+ * @param filename  The file
+ * @param offset    The offset of the value from the start of the file
+ * @return The value
+ */
+template <typename T>
+T readFile(const std::string& filename, std::size_t offset)
+{
+  T value;
+  std::ifstream file(filename,std::ios::binary);
+  file.seekg(offset);
+  file.read(reinterpret_cast<char*>(&value),sizeof(value));
+  return value;
+}
+
+/** @brief This tests that the trajectory with the nearest start and goal within the distance limit is found */
+TEST(TrajectoryLibrary,find_nearest)
+{
+  TrajectoryLibrary library(LIBRARY_GROUP,LIBRARY_JOINTS,100);
+  Eigen::MatrixXd trajectory;
+  EXPECT_FALSE(library.findNearest(Eigen::Vector2d(0.0,0.0),Eigen::Vector2d(1.0,1.0),1.0,trajectory));
+
+  // a grid of trajectories, enough for the kd-tree to be rebuilt and inserted into several times
+  for(int i = 0; i < 7; i++)
+  {
+    for(int j = 0; j < 7; j++)
+    {
+      library.add(createLinearTrajectory(Eigen::Vector2d(0.1*i,0.1*j),Eigen::Vector2d(1.0 - 0.1*j,1.0 + 0.1*i)));
+    }
+  }
+  EXPECT_EQ(library.size(),49u);
+
+  for(int i = 0; i < 7; i++)
+  {
+    for(int j = 0; j < 7; j++)
+    {
+      Eigen::Vector2d start(0.1*i + 0.01,0.1*j - 0.01);
+      Eigen::Vector2d goal(1.0 - 0.1*j + 0.01,1.0 + 0.1*i);
+      ASSERT_TRUE(library.findNearest(start,goal,0.05,trajectory));
+      Eigen::MatrixXd expected = createLinearTrajectory(Eigen::Vector2d(0.1*i,0.1*j),
+                                                        Eigen::Vector2d(1.0 - 0.1*j,1.0 + 0.1*i));
+      EXPECT_TRUE(trajectory.isApprox(expected));
+    }
+  }
+
+  // beyond the distance limit or of other dimensions
+  EXPECT_FALSE(library.findNearest(Eigen::Vector2d(5.0,5.0),Eigen::Vector2d(5.0,5.0),0.5,trajectory));
+  EXPECT_FALSE(library.findNearest(Eigen::Vector3d(0.0,0.0,0.0),Eigen::Vector3d(1.0,1.0,0.0),1.0,trajectory));
+}
+
+/** @brief This tests that the oldest trajectory is replaced once the library is full */
+TEST(TrajectoryLibrary,capacity)
+{
+  TrajectoryLibrary library(LIBRARY_GROUP,LIBRARY_JOINTS,2);
+  library.add(createLinearTrajectory(Eigen::Vector2d(0.0,0.0),Eigen::Vector2d(1.0,1.0)));
+  library.add(createLinearTrajectory(Eigen::Vector2d(2.0,2.0),Eigen::Vector2d(3.0,3.0)));
+  library.add(createLinearTrajectory(Eigen::Vector2d(4.0,4.0),Eigen::Vector2d(5.0,5.0)));
+  EXPECT_EQ(library.size(),2u);
+
+  Eigen::MatrixXd trajectory;
+  EXPECT_FALSE(library.findNearest(Eigen::Vector2d(0.0,0.0),Eigen::Vector2d(1.0,1.0),0.1,trajectory));
+  EXPECT_TRUE(library.findNearest(Eigen::Vector2d(2.0,2.0),Eigen::Vector2d(3.0,3.0),0.1,trajectory));
+  EXPECT_TRUE(library.findNearest(Eigen::Vector2d(4.0,4.0),Eigen::Vector2d(5.0,5.0),0.1,trajectory));
+
+  // a trajectory of other dimensions is rejected
+  library.add(Eigen::MatrixXd::Zero(3,LIBRARY_TIMESTEPS));
+  EXPECT_EQ(library.size(),2u);
+}
+
+/** @brief This tests that a saved library is loaded with the same trajectories and can still be added to */
+TEST(TrajectoryLibrary,save_load)
+{
+  std::string filename = getLibraryFileName("save_load");
+  std::vector<Eigen::MatrixXd> trajectories;
+  {
+    TrajectoryLibrary library(LIBRARY_GROUP,LIBRARY_JOINTS,10);
+    for(int i = 0; i < 5; i++)
+    {
+      trajectories.push_back(createLinearTrajectory(Eigen::Vector2d(0.25*i,-0.5*i),Eigen::Vector2d(1.0,0.125*i)));
+      library.add(trajectories.back(),i);
+    }
+    ASSERT_TRUE(library.save(filename));
+  }
+
+  TrajectoryLibrary library(LIBRARY_GROUP,LIBRARY_JOINTS,10);
+  ASSERT_TRUE(library.load(filename));
+  EXPECT_EQ(library.size(),trajectories.size());
+
+  // the trajectories are stored as floats
+  Eigen::MatrixXd trajectory;
+  for(const auto& t : trajectories)
+  {
+    ASSERT_TRUE(library.findNearest(t.leftCols(1),t.rightCols(1),1e-3,trajectory));
+    ASSERT_EQ(trajectory.rows(),t.rows());
+    ASSERT_EQ(trajectory.cols(),t.cols());
+    EXPECT_LT((trajectory - t).cwiseAbs().maxCoeff(),1e-6);
+  }
+
+  // the loaded trajectories are saved along with the added ones
+  library.add(createLinearTrajectory(Eigen::Vector2d(-2.0,-2.0),Eigen::Vector2d(2.0,2.0)));
+  EXPECT_EQ(library.size(),trajectories.size() + 1);
+  ASSERT_TRUE(library.save(filename));
+
+  TrajectoryLibrary reloaded(LIBRARY_GROUP,LIBRARY_JOINTS,10);
+  ASSERT_TRUE(reloaded.load(filename));
+  EXPECT_EQ(reloaded.size(),trajectories.size() + 1);
+  EXPECT_TRUE(reloaded.findNearest(Eigen::Vector2d(-2.0,-2.0),Eigen::Vector2d(2.0,2.0),1e-3,trajectory));
+
+  std::remove(filename.c_str());
+}
+
+/** @brief This tests that files which are not a valid library of the group's joints are rejected */
+TEST(TrajectoryLibrary,load_invalid)
+{
+  TrajectoryLibrary library(LIBRARY_GROUP,LIBRARY_JOINTS,10);
+  EXPECT_FALSE(library.load(getLibraryFileName("missing")));
+
+  std::string filename = getLibraryFileName("load_invalid");
+  {
+    TrajectoryLibrary saved(LIBRARY_GROUP,LIBRARY_JOINTS,10);
+    saved.add(createLinearTrajectory(Eigen::Vector2d(0.0,0.0),Eigen::Vector2d(1.0,1.0)));
+    ASSERT_TRUE(saved.save(filename));
+  }
+
+  std::string contents;
+  {
+    std::ifstream file(filename,std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>());
+  }
+  auto restore = [&]()
+  {
+    std::ofstream file(filename,std::ios::binary | std::ios::trunc);
+    file.write(contents.data(),contents.size());
+  };
+
+  // the header is the magic, the version, the number of dimensions, the number of entries and the offsets
+  const std::size_t VERSION_OFFSET = 8;
+  const std::size_t ENTRIES_OFFSET_OFFSET = 40;
+  uint64_t entries_offset = readFile<uint64_t>(filename,ENTRIES_OFFSET_OFFSET);
+
+  patchFile(filename,0,'X');
+  EXPECT_FALSE(library.load(filename));
+  restore();
+
+  patchFile(filename,VERSION_OFFSET,uint32_t(1));
+  EXPECT_FALSE(library.load(filename));
+  restore();
+
+  // the entries out of the file
+  patchFile(filename,ENTRIES_OFFSET_OFFSET,uint64_t(contents.size()));
+  EXPECT_FALSE(library.load(filename));
+  restore();
+
+  // an entry whose trajectory is too short or runs past the end of the file, each record starts with its cost
+  patchFile(filename,entries_offset + sizeof(double),uint32_t(1));
+  EXPECT_FALSE(library.load(filename));
+  restore();
+
+  patchFile(filename,entries_offset + sizeof(double),uint32_t(1000000));
+  EXPECT_FALSE(library.load(filename));
+  restore();
+
+  // truncated
+  {
+    std::ofstream file(filename,std::ios::binary | std::ios::trunc);
+    file.write(contents.data(),16);
+  }
+  EXPECT_FALSE(library.load(filename));
+  restore();
+
+  // other joints or dimensions
+  TrajectoryLibrary other_joints(LIBRARY_GROUP,{"joint1", "joint3"},10);
+  EXPECT_FALSE(other_joints.load(filename));
+  TrajectoryLibrary other_dimensions(LIBRARY_GROUP,{"joint1"},10);
+  EXPECT_FALSE(other_dimensions.load(filename));
+  TrajectoryLibrary other_group("other_arm",LIBRARY_JOINTS,10);
+  EXPECT_FALSE(other_group.load(filename));
+
+  EXPECT_EQ(library.size(),0u);
+  EXPECT_TRUE(library.load(filename));
+  EXPECT_EQ(library.size(),1u);
+
+  std::remove(filename.c_str());
+}
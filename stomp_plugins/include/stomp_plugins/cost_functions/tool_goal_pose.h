@@ -32,6 +32,7 @@
 #include <moveit/collision_detection_fcl/collision_robot_fcl.h>
 #include <stomp_moveit/utils/kinematics.h>
 #include "stomp_moveit/cost_functions/stomp_cost_function.h"
+#include "stomp_moveit/utils/robot_state_pool.h"
 
 namespace stomp_moveit
 {
@@ -131,6 +132,7 @@ protected:
   std::string group_name_;
   std::string tool_link_;
   moveit::core::RobotModelConstPtr robot_model_;
+  utils::RobotStatePoolPtr state_pool_;    /**< @brief Hands out the robot states reused across requests */
   moveit::core::RobotStatePtr state_;
 
   // planning context information
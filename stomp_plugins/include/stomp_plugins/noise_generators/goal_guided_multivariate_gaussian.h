@@ -30,6 +30,7 @@
 #include <stomp_moveit/noise_generators/stomp_noise_generator.h>
 #include <stomp_moveit/utils/multivariate_gaussian.h>
 #include "stomp_moveit/utils/kinematics.h"
+#include "stomp_moveit/utils/robot_state_pool.h"
 
 
 namespace stomp_moveit
@@ -167,6 +168,7 @@ protected:
 
   // robot
   moveit::core::RobotModelConstPtr robot_model_;
+  utils::RobotStatePoolPtr state_pool_;    /**< @brief Hands out the robot states reused across requests */
   moveit::core::RobotStatePtr state_;
   stomp_moveit::utils::kinematics::IKSolverPtr ik_solver_;
 
@@ -29,6 +29,7 @@
 
 #include <stomp_moveit/update_filters/stomp_update_filter.h>
 #include <stomp_moveit/utils/kinematics.h>
+#include <stomp_moveit/utils/robot_state_pool.h>
 
 namespace stomp_moveit
 {
@@ -121,6 +122,7 @@ protected:
 
   // robot
   moveit::core::RobotModelConstPtr robot_model_;
+  utils::RobotStatePoolPtr state_pool_;    /**< @brief Hands out the robot states reused across requests */
   moveit::core::RobotStatePtr state_;
   stomp_moveit::utils::kinematics::IKSolverPtr ik_solver_;
   std::string tool_link_;
@@ -59,6 +59,7 @@ bool ToolGoalPose::initialize(moveit::core::RobotModelConstPtr robot_model_ptr,
 {
   group_name_ = group_name;
   robot_model_ = robot_model_ptr;
+  state_pool_ = utils::RobotStatePool::get(robot_model_ptr);
 
   return configure(config);
 }
@@ -98,7 +99,7 @@ bool ToolGoalPose::setMotionPlanRequest(const planning_scene::PlanningSceneConst
   const JointModelGroup* joint_group = robot_model_->getJointModelGroup(group_name_);
   int num_joints = joint_group->getActiveJointModels().size();
   tool_link_ = joint_group->getLinkModelNames().back();
-  state_.reset(new RobotState(robot_model_));
+  state_ = state_pool_->checkout();
   robotStateMsgToRobotState(req.start_state,*state_);
 
   const std::vector<moveit_msgs::Constraints>& goals = req.goal_constraints;
@@ -68,6 +68,7 @@ bool GoalGuidedMultivariateGaussian::initialize(moveit::core::RobotModelConstPtr
   // robot model details
   group_ = group_name;
   robot_model_ = robot_model_ptr;
+  state_pool_ = utils::RobotStatePool::get(robot_model_ptr);
   const JointModelGroup* joint_group = robot_model_ptr->getJointModelGroup(group_name);
   if(!joint_group)
   {
@@ -144,8 +145,8 @@ bool GoalGuidedMultivariateGaussian::setupNoiseGeneration(const planning_scene::
     m.diagonal(diag_index) = VectorXd::Constant(size,coeff);
   };
 
-  // creating finite difference acceleration matrix
-  std::size_t num_timesteps = config.num_timesteps;
+  // creating finite difference acceleration matrix, the noise is generated for each optimized parameter
+  std::size_t num_timesteps = stomp_core::getNumParameters(config);
   Eigen::MatrixXd A = MatrixXd::Zero(num_timesteps,num_timesteps);
   int num_elements = (int((ACC_MATRIX_DIAGONAL_INDICES.size() -1)/2.0) + 1)* num_timesteps ;
   for(auto i = 0u; i < ACC_MATRIX_DIAGONAL_INDICES.size() ; i++)
@@ -168,7 +169,7 @@ bool GoalGuidedMultivariateGaussian::setupNoiseGeneration(const planning_scene::
   }
 
   // preallocating noise data
-  raw_noise_.resize(config.num_timesteps);
+  raw_noise_.resize(num_timesteps);
   raw_noise_.setZero();
 
   error_code.val = error_code.SUCCESS;
@@ -190,7 +191,7 @@ bool GoalGuidedMultivariateGaussian::setupGoalConstraints(const planning_scene::
   const JointModelGroup* joint_group = robot_model_->getJointModelGroup(group_);
   int num_joints = joint_group->getActiveJointModels().size();
   tool_link_ = joint_group->getLinkModelNames().back();
-  state_.reset(new RobotState(robot_model_));
+  state_ = state_pool_->checkout();
   robotStateMsgToRobotState(req.start_state,*state_);
 
   // update kinematic model
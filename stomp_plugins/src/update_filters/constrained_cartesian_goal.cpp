@@ -61,6 +61,7 @@ bool ConstrainedCartesianGoal::initialize(moveit::core::RobotModelConstPtr robot
 {
   group_name_ = group_name;
   robot_model_ = robot_model_ptr;
+  state_pool_ = utils::RobotStatePool::get(robot_model_ptr);
   ik_solver_.reset(new stomp_moveit::utils::kinematics::IKSolver(robot_model_ptr,group_name));
 
   return configure(config);
@@ -84,7 +85,7 @@ bool ConstrainedCartesianGoal::setMotionPlanRequest(const planning_scene::Planni
   const JointModelGroup* joint_group = robot_model_->getJointModelGroup(group_name_);
   int num_joints = joint_group->getActiveJointModels().size();
   tool_link_ = joint_group->getLinkModelNames().back();
-  state_.reset(new RobotState(robot_model_));
+  state_ = state_pool_->checkout();
   robotStateMsgToRobotState(req.start_state,*state_);
 
   // update kinematic model